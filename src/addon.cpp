@@ -22,12 +22,15 @@
 
 #include "addon.h"
 
+#include "api/EventPool.h"
 #include "api/Joystick.h"
 #include "api/JoystickManager.h"
 #include "api/PeripheralScanner.h"
+#include "api/ScanResultCache.h"
 #include "filesystem/Filesystem.h"
 #include "log/Log.h"
 #include "log/LogAddon.h"
+#include "log/Trace.h"
 #include "settings/Settings.h"
 #include "storage/StorageManager.h"
 #include "utils/CommonIncludes.h"
@@ -39,12 +42,15 @@
 using namespace JOYSTICK;
 
 CPeripheralJoystick::CPeripheralJoystick() :
-  m_scanner(nullptr)
+  m_scanner(nullptr),
+  m_scanResults(new CScanResultCache)
 {
 }
 
 ADDON_STATUS CPeripheralJoystick::Create()
 {
+  TRACE_SCOPE("CPeripheralJoystick::Create");
+
   CLog::Get().SetPipe(new CLogAddon());
 
   if (!CFilesystem::Initialize())
@@ -81,9 +87,12 @@ CPeripheralJoystick::~CPeripheralJoystick()
   CJoystickManager::Get().Deinitialize();
   CFilesystem::Deinitialize();
 
+  CTrace::Get().Write();
+
   CLog::Get().SetType(SYS_LOG_TYPE_CONSOLE);
 
   delete m_scanner;
+  delete m_scanResults;
 }
 
 void CPeripheralJoystick::GetCapabilities(PERIPHERAL_CAPABILITIES& capabilities)
@@ -98,23 +107,28 @@ PERIPHERAL_ERROR CPeripheralJoystick::PerformDeviceScan(unsigned int* peripheral
     return PERIPHERAL_ERROR_INVALID_PARAMETERS;
 
   JoystickVector joysticks;
-  if (!CJoystickManager::Get().PerformJoystickScan(joysticks))
+  JoystickVector newJoysticks;
+  unsigned int generation;
+  if (!CJoystickManager::Get().PerformJoystickScan(joysticks, generation, &newJoysticks))
     return PERIPHERAL_ERROR_FAILED;
 
-  // Upcast array pointers
-  std::vector<kodi::addon::Peripheral*> peripherals;
-  for (JoystickVector::const_iterator it = joysticks.begin(); it != joysticks.end(); ++it)
-    peripherals.push_back(it->get());
+  // The frontend asks for features of new joysticks right away, so have them
+  // ready
+  for (const auto& joystick : newJoysticks)
+    CStorageManager::Get().PrefetchFeatures(*joystick);
 
-  *peripheral_count = static_cast<unsigned int>(peripherals.size());
-  kodi::addon::Peripherals::ToStructs(peripherals, scan_results);
+  // Only converted when the set of joysticks has changed
+  m_scanResults->GetResults(generation, joysticks, *peripheral_count, *scan_results);
+
+  // Make the trace available without unloading the add-on
+  CTrace::Get().WriteIfDue();
 
   return PERIPHERAL_NO_ERROR;
 }
 
 void CPeripheralJoystick::FreeScanResults(unsigned int peripheral_count, PERIPHERAL_INFO* scan_results)
 {
-  kodi::addon::Peripherals::FreeStructs(peripheral_count, scan_results);
+  m_scanResults->FreeResults(peripheral_count, scan_results);
 }
 
 PERIPHERAL_ERROR CPeripheralJoystick::GetEvents(unsigned int* event_count, PERIPHERAL_EVENT** events)
@@ -124,22 +138,21 @@ PERIPHERAL_ERROR CPeripheralJoystick::GetEvents(unsigned int* event_count, PERIP
 
   PERIPHERAL_ERROR result = PERIPHERAL_ERROR_FAILED;
 
-  std::vector<kodi::addon::PeripheralEvent> peripheralEvents;
+  // Buffers are reused between frames to avoid allocating at the poll rate
+  std::vector<kodi::addon::PeripheralEvent>& peripheralEvents = CEventPool::GetEventList();
   if (CJoystickManager::Get().GetEvents(peripheralEvents))
   {
     *event_count = static_cast<unsigned int>(peripheralEvents.size());
-    kodi::addon::PeripheralEvents::ToStructs(peripheralEvents, events);
+    CEventPool::ToStructs(peripheralEvents, events);
     result = PERIPHERAL_NO_ERROR;
   }
 
-  CJoystickManager::Get().ProcessEvents();
-
   return result;
 }
 
 void CPeripheralJoystick::FreeEvents(unsigned int event_count, PERIPHERAL_EVENT* events)
 {
-  kodi::addon::PeripheralEvents::FreeStructs(event_count, events);
+  CEventPool::FreeStructs(event_count, events);
 }
 
 bool CPeripheralJoystick::SendEvent(const PERIPHERAL_EVENT* event)
@@ -26,6 +26,7 @@
 namespace JOYSTICK
 {
   class CPeripheralScanner;
+  class CScanResultCache;
 }
 
 class DLL_PRIVATE CPeripheralJoystick
@@ -67,4 +68,5 @@ public:
 
 private:
   JOYSTICK::CPeripheralScanner* m_scanner;
+  JOYSTICK::CScanResultCache*   m_scanResults;
 };
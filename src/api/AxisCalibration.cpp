@@ -0,0 +1,101 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AxisCalibration.h"
+
+#include <algorithm>
+#include <stdlib.h>
+
+using namespace JOYSTICK;
+
+// Axis codes from linux/input-event-codes.h, duplicated so that recordings
+// can be calibrated on any platform
+#define EVDEV_ABS_X  0x00
+#define EVDEV_ABS_Y  0x01
+
+bool CAxisCalibration::IsEvdevTrigger(unsigned int code, int minimum)
+{
+  // Signed axes rest at zero
+  if (minimum < 0)
+    return false;
+
+  switch (code)
+  {
+    case EVDEV_ABS_X:
+    case EVDEV_ABS_Y:
+      return false;
+    default:
+      break;
+  }
+
+  return true;
+}
+
+void CAxisCalibration::Calibrate(int minimum, int maximum, int flat, int fuzz, bool bTrigger)
+{
+  if (minimum < 0)
+    m_center = 0.0f;
+  else if (bTrigger)
+    m_center = static_cast<float>(minimum);
+  else
+    m_center = (minimum + maximum) / 2.0f; // e.g. 0-255 with the center at 127.5
+
+  // The kernel's flat zone is around the center of the range (see joydev),
+  // so it doesn't apply to an axis resting at its minimum
+  m_flat = bTrigger ? 0 : std::max(flat, 0);
+  m_fuzz = std::max(fuzz, 0);
+
+  const float positiveRange = maximum - m_center - m_flat;
+  const float negativeRange = m_center - minimum - m_flat;
+
+  m_scalePositive = positiveRange > 0.0f ? 1.0f / positiveRange : 0.0f;
+  m_scaleNegative = negativeRange > 0.0f ? 1.0f / negativeRange : 0.0f;
+
+  m_bHasValue = false;
+}
+
+bool CAxisCalibration::Apply(int rawValue, float& value)
+{
+  if (m_bHasValue)
+  {
+    // Drop jitter that the driver didn't filter
+    if (2 * std::abs(rawValue - m_lastRawValue) < m_fuzz)
+      return false;
+  }
+
+  m_lastRawValue = rawValue;
+
+  const float offset = rawValue - m_center;
+
+  if (offset > m_flat)
+    value = (offset - m_flat) * m_scalePositive;
+  else if (offset < -m_flat)
+    value = (offset + m_flat) * m_scaleNegative;
+  else
+    value = 0.0f;
+
+  if (m_bHasValue && value == m_lastValue)
+    return false;
+
+  m_lastValue = value;
+  m_bHasValue = true;
+
+  return true;
+}
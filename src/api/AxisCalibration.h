@@ -0,0 +1,77 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+namespace JOYSTICK
+{
+  /*!
+   * \brief Conversion of raw axis values, precomputed from an axis's range
+   *
+   * Sticks are centered and scaled to [-1.0, 1.0]. Triggers and pedals rest
+   * at their minimum and are scaled to [0.0, 1.0], so existing button maps
+   * still apply. Values within the flat zone around the center of a stick
+   * report 0, and changes smaller than half of the fuzz are dropped as
+   * noise.
+   */
+  class CAxisCalibration
+  {
+  public:
+    CAxisCalibration(void) = default;
+
+    /*!
+     * \brief Check if an evdev axis rests at its minimum, like a trigger or
+     *        pedal
+     *
+     * The decision only depends on the axis properties, never on the value
+     * when the device is opened. Signed axes rest at zero. Of the unsigned
+     * axes, only ABS_X and ABS_Y are known to be sticks: drivers put
+     * triggers and the right stick on ABS_Z, ABS_RZ, ABS_RX and ABS_RY
+     * differently (e.g. hid-sony and hid-playstation for the same pad), and
+     * hid-input gives every axis a flat zone. Other unsigned axes keep the
+     * [0.0, 1.0] mapping that existing button maps were made with.
+     *
+     * \param code The ABS_* code of the axis
+     * \param minimum The minimum of the axis range
+     */
+    static bool IsEvdevTrigger(unsigned int code, int minimum);
+
+    /*!
+     * \brief Compute the conversion for an axis range
+     */
+    void Calibrate(int minimum, int maximum, int flat, int fuzz, bool bTrigger);
+
+    /*!
+     * \brief Convert a raw axis value
+     *
+     * \return False if the value is noise or maps to the last reported value
+     */
+    bool Apply(int rawValue, float& value);
+
+  private:
+    float m_center = 0.0f;        // Raw value at rest
+    int   m_flat = 0;             // Raw distance from the center reported as 0
+    int   m_fuzz = 0;             // Raw changes smaller than half of this are noise
+    float m_scalePositive = 0.0f; // Raw distance beyond flat -> [0.0, 1.0]
+    float m_scaleNegative = 0.0f; // Raw distance beyond flat -> [-1.0, 0.0]
+    int   m_lastRawValue = 0;
+    float m_lastValue = 0.0f;
+    bool  m_bHasValue = false;
+  };
+}
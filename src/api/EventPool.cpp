@@ -0,0 +1,122 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "EventPool.h"
+
+#include "p8-platform/threads/mutex.h"
+
+#include <memory>
+
+using namespace JOYSTICK;
+using namespace P8PLATFORM;
+
+#define MAX_POOLED_ARRAYS  4 // More than this are outstanding only if the frontend leaks them
+
+namespace
+{
+  struct EventArray
+  {
+    std::vector<PERIPHERAL_EVENT> structs;
+    bool                          bInUse = false;
+  };
+
+  // Arrays may be freed on a different thread than the one that polled, so
+  // they are shared between threads
+  std::vector<std::unique_ptr<EventArray>> pool;
+  CMutex poolMutex;
+}
+
+std::vector<kodi::addon::PeripheralEvent>& CEventPool::GetEventList(void)
+{
+  // Only used for the duration of a GetEvents() call
+  static thread_local std::vector<kodi::addon::PeripheralEvent> events;
+
+  events.clear();
+  return events;
+}
+
+void CEventPool::ToStructs(const std::vector<kodi::addon::PeripheralEvent>& events, PERIPHERAL_EVENT** structs)
+{
+  if (events.empty())
+  {
+    *structs = nullptr;
+    return;
+  }
+
+  EventArray* array = nullptr;
+
+  {
+    CLockObject lock(poolMutex);
+
+    for (auto& pooledArray : pool)
+    {
+      if (!pooledArray->bInUse)
+      {
+        array = pooledArray.get();
+        break;
+      }
+    }
+
+    if (array == nullptr && pool.size() < MAX_POOLED_ARRAYS)
+    {
+      pool.emplace_back(new EventArray);
+      array = pool.back().get();
+    }
+
+    if (array != nullptr)
+      array->bInUse = true;
+  }
+
+  if (array == nullptr)
+  {
+    kodi::addon::PeripheralEvents::ToStructs(events, structs);
+    return;
+  }
+
+  // Never shrinks, so steady-state polling doesn't allocate
+  if (array->structs.size() < events.size())
+    array->structs.resize(events.size());
+
+  for (unsigned int i = 0; i < events.size(); i++)
+    events[i].ToStruct(array->structs[i]);
+
+  *structs = array->structs.data();
+}
+
+void CEventPool::FreeStructs(unsigned int eventCount, PERIPHERAL_EVENT* structs)
+{
+  if (structs == nullptr)
+    return;
+
+  {
+    CLockObject lock(poolMutex);
+
+    for (auto& pooledArray : pool)
+    {
+      if (pooledArray->bInUse && pooledArray->structs.data() == structs)
+      {
+        pooledArray->bInUse = false;
+        return;
+      }
+    }
+  }
+
+  kodi::addon::PeripheralEvents::FreeStructs(eventCount, structs);
+}
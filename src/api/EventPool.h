@@ -0,0 +1,59 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <kodi/addon-instance/Peripheral.h>
+#include <kodi/addon-instance/PeripheralUtils.h>
+
+#include <vector>
+
+namespace JOYSTICK
+{
+  /*!
+   * \brief Grow-only buffers for the events returned by GetEvents()
+   *
+   * The frontend polls for events every frame and frees the array right
+   * after. Event lists are kept per polling thread, and the arrays handed to
+   * the frontend come from a small pool, so neither is reallocated once it
+   * has grown to the largest frame. Empty results don't allocate at all.
+   */
+  class CEventPool
+  {
+  public:
+    /*!
+     * \brief Get the calling thread's event list, emptied, for collecting
+     *        events
+     */
+    static std::vector<kodi::addon::PeripheralEvent>& GetEventList(void);
+
+    /*!
+     * \brief Convert events into an array owned by the pool
+     *
+     * \param events The events to convert
+     * \param[out] structs The array, or nullptr if there are no events
+     */
+    static void ToStructs(const std::vector<kodi::addon::PeripheralEvent>& events, PERIPHERAL_EVENT** structs);
+
+    /*!
+     * \brief Release an array returned by ToStructs()
+     */
+    static void FreeStructs(unsigned int eventCount, PERIPHERAL_EVENT* structs);
+  };
+}
@@ -0,0 +1,75 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ForceFeedbackWorker.h"
+#include "JoystickManager.h"
+#include "log/Log.h"
+
+using namespace JOYSTICK;
+
+// Retry interval for output that a joystick deferred, such as a rate-limited
+// rumble update
+#define PENDING_OUTPUT_RETRY_MS  5
+
+bool CForceFeedbackWorker::Start(void)
+{
+  if (IsRunning())
+    return true;
+
+  if (!CreateThread(false))
+  {
+    esyslog("Failed to start force-feedback worker");
+    return false;
+  }
+
+  return true;
+}
+
+void CForceFeedbackWorker::Stop(void)
+{
+  StopThread(-1);
+  m_outputEvent.Signal();
+  StopThread();
+}
+
+void CForceFeedbackWorker::Notify(void)
+{
+  m_outputEvent.Signal();
+}
+
+void* CForceFeedbackWorker::Process(void)
+{
+  bool bPending = false;
+
+  while (!IsStopped())
+  {
+    if (bPending)
+      m_outputEvent.Wait(PENDING_OUTPUT_RETRY_MS);
+    else
+      m_outputEvent.Wait();
+
+    if (IsStopped())
+      break;
+
+    bPending = CJoystickManager::Get().ProcessEvents();
+  }
+
+  return nullptr;
+}
@@ -0,0 +1,63 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "p8-platform/threads/mutex.h"
+#include "p8-platform/threads/threads.h"
+
+namespace JOYSTICK
+{
+  /*!
+   * \brief Applies force-feedback output away from the input path
+   *
+   * Joysticks keep the latest motor state requested by SendEvent() as a
+   * mailbox. The worker is woken when a new value is posted and calls
+   * CJoystickManager::ProcessEvents() to apply it, so slow output I/O never
+   * delays polling for input.
+   */
+  class CForceFeedbackWorker : protected P8PLATFORM::CThread
+  {
+  public:
+    CForceFeedbackWorker(void) = default;
+    virtual ~CForceFeedbackWorker(void) { Stop(); }
+
+    /*!
+     * \brief Start the worker thread
+     */
+    bool Start(void);
+
+    /*!
+     * \brief Stop the worker thread and wait for it to exit
+     */
+    void Stop(void);
+
+    /*!
+     * \brief Wake the worker because new output has been posted
+     */
+    void Notify(void);
+
+  protected:
+    // implementation of CThread
+    virtual void* Process(void) override;
+
+  private:
+    P8PLATFORM::CEvent m_outputEvent;
+  };
+}
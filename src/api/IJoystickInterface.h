@@ -72,6 +72,24 @@ namespace JOYSTICK
      */
     virtual bool ScanForJoysticks(JoystickVector& joysticks) = 0;
 
+    /*!
+     * \brief Check if ScanForJoysticks() could return a different result
+     *
+     * Interfaces that announce every hotplug through
+     * CJoystickManager::SetChanged() can return false, which lets the manager
+     * answer scans from its cached results. Interfaces that can only detect
+     * changes by probing must return true.
+     */
+    virtual bool NeedsScan(void) { return true; }
+
+    /*!
+     * \brief Process interface-wide events before the joysticks are polled
+     *
+     * Interfaces that receive input through a shared event queue dispatch it
+     * to their joysticks here.
+     */
+    virtual void PollEvents(void) { }
+
     /*!
      * \brief Get the button map known to the interface
      *
@@ -0,0 +1,339 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "InputReader.h"
+#include "JoystickManager.h"
+#include "log/Log.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sstream>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace JOYSTICK;
+
+#define THREAD_ENVIRONMENT_VARIABLE    "KODI_JOYSTICK_INPUT_THREAD"
+#define POLICY_ENVIRONMENT_VARIABLE    "KODI_JOYSTICK_INPUT_POLICY"
+#define PRIORITY_ENVIRONMENT_VARIABLE  "KODI_JOYSTICK_INPUT_PRIORITY"
+#define CPUS_ENVIRONMENT_VARIABLE      "KODI_JOYSTICK_INPUT_CPUS"
+#define MLOCK_ENVIRONMENT_VARIABLE     "KODI_JOYSTICK_INPUT_MLOCK"
+#define INTERVAL_ENVIRONMENT_VARIABLE  "KODI_JOYSTICK_INPUT_INTERVAL_MS"
+
+#define DEFAULT_RT_PRIORITY  10
+#define MAX_INTERVAL_MS      100
+#define MAX_WAIT_MS          1000 // Bounds the wait in case a change of joysticks is missed
+
+#ifndef INVALID_FD
+  #define INVALID_FD  (-1)
+#endif
+
+CInputReader::CInputReader(void) :
+  m_wakeFd(INVALID_FD),
+  m_bMemoryLocked(false)
+{
+}
+
+bool CInputReader::IsEnabled(void)
+{
+  const char* strEnabled = getenv(THREAD_ENVIRONMENT_VARIABLE);
+  return strEnabled != nullptr && atoi(strEnabled) != 0;
+}
+
+InputThreadProfile CInputReader::GetProfile(void)
+{
+  InputThreadProfile profile;
+
+  const char* strPolicy = getenv(POLICY_ENVIRONMENT_VARIABLE);
+  if (strPolicy != nullptr && *strPolicy != '\0')
+  {
+    if (strcmp(strPolicy, "fifo") == 0)
+      profile.policy = SCHED_FIFO;
+    else if (strcmp(strPolicy, "rr") == 0)
+      profile.policy = SCHED_RR;
+    else
+      esyslog("Invalid input thread policy \"%s\", using normal scheduling", strPolicy);
+  }
+
+  if (profile.policy >= 0)
+  {
+    profile.priority = DEFAULT_RT_PRIORITY;
+
+    const char* strPriority = getenv(PRIORITY_ENVIRONMENT_VARIABLE);
+    if (strPriority != nullptr)
+    {
+      const int minPriority = sched_get_priority_min(profile.policy);
+      const int maxPriority = sched_get_priority_max(profile.policy);
+      const int priority = atoi(strPriority);
+
+      if (minPriority <= priority && priority <= maxPriority)
+        profile.priority = priority;
+      else
+        esyslog("Invalid input thread priority \"%s\", using %d", strPriority, DEFAULT_RT_PRIORITY);
+    }
+  }
+
+  const char* strCpus = getenv(CPUS_ENVIRONMENT_VARIABLE);
+  if (strCpus != nullptr && *strCpus != '\0')
+  {
+    if (!ParseCpus(strCpus, profile.cpus))
+    {
+      esyslog("Invalid input thread CPUs \"%s\", not pinning", strCpus);
+      profile.cpus.clear();
+    }
+  }
+
+  const char* strLock = getenv(MLOCK_ENVIRONMENT_VARIABLE);
+  profile.bLockMemory = (strLock != nullptr && atoi(strLock) != 0);
+
+  const char* strInterval = getenv(INTERVAL_ENVIRONMENT_VARIABLE);
+  if (strInterval != nullptr)
+  {
+    const int intervalMs = atoi(strInterval);
+    if (0 < intervalMs && intervalMs <= MAX_INTERVAL_MS)
+      profile.intervalMs = intervalMs;
+    else
+      esyslog("Invalid input thread interval \"%s\", using %u ms", strInterval, profile.intervalMs);
+  }
+
+  return profile;
+}
+
+bool CInputReader::Start(const InputThreadProfile& profile)
+{
+  if (IsRunning())
+    return true;
+
+  m_profile = profile;
+
+  m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (m_wakeFd < 0)
+  {
+    esyslog("Failed to create input reader eventfd: %s", strerror(errno));
+    return false;
+  }
+
+  if (!CreateThread(false))
+  {
+    esyslog("Failed to start input reader");
+    close(m_wakeFd);
+    m_wakeFd = INVALID_FD;
+    return false;
+  }
+
+  return true;
+}
+
+void CInputReader::Stop(void)
+{
+  StopThread(-1);
+  Wake();
+  StopThread();
+
+  if (m_wakeFd >= 0)
+  {
+    close(m_wakeFd);
+    m_wakeFd = INVALID_FD;
+  }
+}
+
+void CInputReader::Wake(void)
+{
+  if (m_wakeFd >= 0)
+  {
+    const uint64_t count = 1;
+    if (write(m_wakeFd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+      esyslog("Failed to wake input reader: %s", strerror(errno));
+  }
+}
+
+void* CInputReader::Process(void)
+{
+  ApplyProfile();
+
+  while (!IsStopped())
+  {
+    CJoystickManager::Get().ReadInput();
+
+    WaitForInput();
+  }
+
+  if (m_bMemoryLocked)
+  {
+    munlockall();
+    m_bMemoryLocked = false;
+  }
+
+  return nullptr;
+}
+
+void CInputReader::WaitForInput(void)
+{
+  std::vector<int> deviceFds;
+  const bool bAllWaitable = CJoystickManager::Get().GetInputFds(deviceFds);
+
+  std::vector<pollfd> fds;
+  fds.reserve(deviceFds.size() + 1);
+
+  fds.push_back({ m_wakeFd, POLLIN, 0 });
+  for (int fd : deviceFds)
+    fds.push_back({ fd, POLLIN, 0 });
+
+  int timeoutMs = bAllWaitable ? MAX_WAIT_MS : static_cast<int>(m_profile.intervalMs);
+
+  // An unplugged device reports an error until the next scan removes it.
+  // Don't spin on it, fall back to the interval.
+  for (unsigned int attempt = 0; attempt < 2; attempt++)
+  {
+    const int ret = poll(fds.data(), fds.size(), timeoutMs);
+    if (ret <= 0)
+      break; // Timeout, or EINTR
+
+    bool bHasError = false;
+    bool bHasInput = false;
+    for (const pollfd& fd : fds)
+    {
+      if (fd.revents & POLLIN)
+        bHasInput = true;
+      else if (fd.revents & (POLLERR | POLLHUP | POLLNVAL))
+        bHasError = true;
+    }
+
+    if (fds[0].revents & POLLIN)
+    {
+      uint64_t count;
+      if (read(m_wakeFd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+        esyslog("Failed to clear input reader wakeup: %s", strerror(errno));
+    }
+
+    if (bHasInput || !bHasError)
+      break;
+
+    fds.resize(1);
+    timeoutMs = static_cast<int>(m_profile.intervalMs);
+  }
+}
+
+void CInputReader::ApplyProfile(void)
+{
+  if (m_profile.policy >= 0)
+  {
+    sched_param param = { };
+    param.sched_priority = m_profile.priority;
+
+    const int ret = pthread_setschedparam(pthread_self(), m_profile.policy, &param);
+    if (ret == 0)
+      isyslog("Input reader: real-time priority %d", m_profile.priority);
+    else if (ret == EPERM)
+      isyslog("Input reader: no permission for real-time scheduling, using normal scheduling");
+    else
+      esyslog("Input reader: failed to set scheduling: %s", strerror(ret));
+  }
+
+  if (!m_profile.cpus.empty())
+  {
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (unsigned int cpu : m_profile.cpus)
+    {
+      if (cpu < CPU_SETSIZE)
+        CPU_SET(cpu, &cpuSet);
+    }
+
+    // 0 is the calling thread
+    if (sched_setaffinity(0, sizeof(cpuSet), &cpuSet) == 0)
+      isyslog("Input reader: pinned to %u CPUs", static_cast<unsigned int>(CPU_COUNT(&cpuSet)));
+    else
+      esyslog("Input reader: failed to set CPU affinity: %s", strerror(errno));
+  }
+
+  if (m_profile.bLockMemory)
+  {
+    // The memory touched while reading isn't owned by this thread: the
+    // io_uring rings and read buffers, the state store and the event pool
+    // are allocated by the joystick manager, and joysticks connected later
+    // add more. Lock the whole process, including future mappings, so none
+    // of it can be paged out.
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0)
+    {
+      isyslog("Input reader: locked current and future memory");
+      m_bMemoryLocked = true;
+    }
+    else
+    {
+      const int error = errno;
+
+      // Without the limit for future mappings, at least keep what exists
+      if (mlockall(MCL_CURRENT) == 0)
+      {
+        isyslog("Input reader: failed to lock future memory (%s), locked current memory only", strerror(error));
+        m_bMemoryLocked = true;
+      }
+      else if (errno == EPERM || errno == ENOMEM)
+        isyslog("Input reader: no permission to lock memory, continuing unlocked");
+      else
+        esyslog("Input reader: failed to lock memory: %s", strerror(errno));
+    }
+  }
+}
+
+bool CInputReader::ParseCpus(const std::string& strCpus, std::vector<unsigned int>& cpus)
+{
+  std::istringstream stream(strCpus);
+  std::string strRange;
+
+  while (std::getline(stream, strRange, ','))
+  {
+    unsigned int first;
+    unsigned int last;
+
+    const size_t dash = strRange.find('-');
+    if (dash == std::string::npos)
+    {
+      char* end = nullptr;
+      first = last = strtoul(strRange.c_str(), &end, 10);
+      if (end == strRange.c_str() || *end != '\0')
+        return false;
+    }
+    else
+    {
+      const std::string strFirst = strRange.substr(0, dash);
+      const std::string strLast = strRange.substr(dash + 1);
+
+      char* end = nullptr;
+      first = strtoul(strFirst.c_str(), &end, 10);
+      if (end == strFirst.c_str() || *end != '\0')
+        return false;
+      last = strtoul(strLast.c_str(), &end, 10);
+      if (end == strLast.c_str() || *end != '\0' || last < first)
+        return false;
+    }
+
+    for (unsigned int cpu = first; cpu <= last; cpu++)
+      cpus.push_back(cpu);
+  }
+
+  return !cpus.empty();
+}
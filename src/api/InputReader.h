@@ -0,0 +1,122 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "p8-platform/threads/threads.h"
+
+#include <string>
+#include <vector>
+
+namespace JOYSTICK
+{
+  /*!
+   * \brief Scheduling of the input reader thread
+   */
+  struct InputThreadProfile
+  {
+    int                       policy = -1;      // SCHED_FIFO or SCHED_RR, or -1 for normal scheduling
+    int                       priority = 0;     // Real-time priority, used with policy
+    std::vector<unsigned int> cpus;             // CPUs to run on, or empty for any CPU
+    bool                      bLockMemory = false;
+    unsigned int              intervalMs = 4;   // Time between reads of joysticks that can't be waited on
+  };
+
+  /*!
+   * \brief Dedicated thread that reads joystick input
+   *
+   * Without the reader, devices are read on the frontend's thread when it
+   * asks for events. With the reader, devices are read on this thread and
+   * GetEvents() only collects the staged state, so the thread's scheduling
+   * can be controlled independently of rendering and audio.
+   *
+   * Between reads, the thread sleeps in poll() until a device node has input.
+   * Joysticks without a device node, e.g. SDL joysticks, are read every
+   * interval instead.
+   *
+   * The reader is enabled with these environment variables:
+   *
+   *   KODI_JOYSTICK_INPUT_THREAD       1 to read on a dedicated thread
+   *   KODI_JOYSTICK_INPUT_POLICY       "fifo" or "rr" for real-time scheduling
+   *   KODI_JOYSTICK_INPUT_PRIORITY     Real-time priority, 1-99
+   *   KODI_JOYSTICK_INPUT_CPUS         CPUs to pin the thread to, e.g. "2,3" or "2-3"
+   *   KODI_JOYSTICK_INPUT_MLOCK        1 to lock the process's memory while reading
+   *   KODI_JOYSTICK_INPUT_INTERVAL_MS  Time between reads without a device node, default 4 ms
+   *
+   * Settings that need privileges the process lacks are skipped with a
+   * message in the log; the thread still runs.
+   *
+   * Memory is locked with mlockall(MCL_CURRENT | MCL_FUTURE), falling back to
+   * MCL_CURRENT, until the thread stops. The buffers that input passes
+   * through are spread over the joystick manager and its backends, so
+   * locking them one by one would miss joysticks connected later. Future
+   * allocations count against RLIMIT_MEMLOCK, so the process needs
+   * CAP_IPC_LOCK or an unlimited limit; otherwise allocations may fail.
+   */
+  class CInputReader : protected P8PLATFORM::CThread
+  {
+  public:
+    CInputReader(void);
+    virtual ~CInputReader(void) { Stop(); }
+
+    /*!
+     * \brief Check if a dedicated reader has been requested
+     */
+    static bool IsEnabled(void);
+
+    /*!
+     * \brief Read the profile from the environment
+     */
+    static InputThreadProfile GetProfile(void);
+
+    /*!
+     * \brief Start reading on the dedicated thread
+     */
+    bool Start(const InputThreadProfile& profile);
+
+    /*!
+     * \brief Stop the thread and wait for it to exit
+     */
+    void Stop(void);
+
+    /*!
+     * \brief Check if devices are being read by the thread
+     */
+    bool IsReading(void) { return IsRunning(); }
+
+    /*!
+     * \brief Interrupt the wait for input, e.g. after the joysticks changed
+     */
+    void Wake(void);
+
+  protected:
+    // implementation of CThread
+    virtual void* Process(void) override;
+
+  private:
+    void ApplyProfile(void);
+    void WaitForInput(void);
+
+    static bool ParseCpus(const std::string& strCpus, std::vector<unsigned int>& cpus);
+
+    InputThreadProfile m_profile;
+    int                m_wakeFd;        // eventfd that interrupts the wait
+    bool               m_bMemoryLocked; // Unlocked when the thread exits
+  };
+}
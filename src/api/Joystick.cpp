@@ -20,12 +20,13 @@
 
 #include "Joystick.h"
 #include "JoystickManager.h"
+#include "JoystickStateStore.h"
 #include "JoystickTranslator.h"
 #include "JoystickUtils.h"
 #include "log/Log.h"
 #include "settings/Settings.h"
 #include "utils/CommonMacros.h"
-#include "utils/StringUtils.h"
+#include "utils/NameCache.h"
 
 #include "p8-platform/util/timeutils.h"
 
@@ -33,8 +34,15 @@ using namespace JOYSTICK;
 
 #define ANALOG_EPSILON  0.0001f
 
+namespace
+{
+  // Shared by all joysticks
+  CNameCache nameCache;
+}
+
 CJoystick::CJoystick(EJoystickInterface interfaceType)
- : m_discoverTimeMs(P8PLATFORM::GetTimeMs()),
+ : m_stateSlot(-1),
+   m_discoverTimeMs(P8PLATFORM::GetTimeMs()),
    m_activateTimeMs(-1),
    m_firstEventTimeMs(-1),
    m_lastEventTimeMs(-1)
@@ -58,12 +66,7 @@ bool CJoystick::Equals(const CJoystick* rhs) const
 
 void CJoystick::SetName(const std::string& strName)
 {
-  std::string strSanitizedFilename = StringUtils::MakeSafeString(strName);
-
-  // Remove Bluetooth MAC address as seen in Sony Playstation controllers
-  StringUtils::RemoveMACAddress(strSanitizedFilename);
-
-  kodi::addon::Joystick::SetName(strSanitizedFilename);
+  kodi::addon::Joystick::SetName(nameCache.Get(strName));
 }
 
 bool CJoystick::Initialize(void)
@@ -74,35 +77,30 @@ bool CJoystick::Initialize(void)
     return false;
   }
 
-  m_state.buttons.assign(ButtonCount(), JOYSTICK_STATE_BUTTON_UNPRESSED);
-  m_state.hats.assign(HatCount(), JOYSTICK_STATE_HAT_UNPRESSED);
-  m_state.axes.resize(AxisCount());
+  CJoystickStateStore& stateStore = CJoystickManager::Get().StateStore();
 
-  m_stateBuffer.buttons.assign(ButtonCount(), JOYSTICK_STATE_BUTTON_UNPRESSED);
-  m_stateBuffer.hats.assign(HatCount(), JOYSTICK_STATE_HAT_UNPRESSED);
-  m_stateBuffer.axes.resize(AxisCount());
+  if (m_stateSlot >= 0)
+    stateStore.Release(m_stateSlot);
+
+  m_stateSlot = stateStore.Allocate(ButtonCount(), HatCount(), AxisCount());
 
   return true;
 }
 
 void CJoystick::Deinitialize(void)
 {
-  m_state.buttons.clear();
-  m_state.hats.clear();
-  m_state.axes.clear();
-
-  m_stateBuffer.buttons.clear();
-  m_stateBuffer.hats.clear();
-  m_stateBuffer.axes.clear();
+  if (m_stateSlot >= 0)
+  {
+    CJoystickManager::Get().StateStore().Release(m_stateSlot);
+    m_stateSlot = -1;
+  }
 }
 
-bool CJoystick::GetEvents(std::vector<kodi::addon::PeripheralEvent>& events)
+bool CJoystick::Update(void)
 {
   if (ScanEvents())
   {
-    GetButtonEvents(events);
-    GetHatEvents(events);
-    GetAxisEvents(events);
+    CJoystickManager::Get().StateStore().Stage(m_stateSlot, Index());
 
     UpdateTimers();
 
@@ -144,72 +142,27 @@ void CJoystick::Activate()
   }
 }
 
-void CJoystick::GetButtonEvents(std::vector<kodi::addon::PeripheralEvent>& events)
-{
-  const std::vector<JOYSTICK_STATE_BUTTON>& buttons = m_stateBuffer.buttons;
-
-  for (unsigned int i = 0; i < buttons.size(); i++)
-  {
-    if (buttons[i] != m_state.buttons[i])
-      events.push_back(kodi::addon::PeripheralEvent(Index(), i, buttons[i]));
-  }
-
-  m_state.buttons.assign(buttons.begin(), buttons.end());
-}
-
-void CJoystick::GetHatEvents(std::vector<kodi::addon::PeripheralEvent>& events)
-{
-  const std::vector<JOYSTICK_STATE_HAT>& hats = m_stateBuffer.hats;
-
-  for (unsigned int i = 0; i < hats.size(); i++)
-  {
-    if (hats[i] != m_state.hats[i])
-      events.push_back(kodi::addon::PeripheralEvent(Index(), i, hats[i]));
-  }
-
-  m_state.hats.assign(hats.begin(), hats.end());
-}
-
-void CJoystick::GetAxisEvents(std::vector<kodi::addon::PeripheralEvent>& events)
-{
-  const std::vector<JoystickAxis>& axes = m_stateBuffer.axes;
-
-  for (unsigned int i = 0; i < axes.size(); i++)
-  {
-    if (axes[i].bSeen)
-      events.push_back(kodi::addon::PeripheralEvent(Index(), i, axes[i].state));
-  }
-
-  m_state.axes.assign(axes.begin(), axes.end());
-}
-
 void CJoystick::SetButtonValue(unsigned int buttonIndex, JOYSTICK_STATE_BUTTON buttonValue)
 {
   Activate();
 
-  if (buttonIndex < m_stateBuffer.buttons.size())
-    m_stateBuffer.buttons[buttonIndex] = buttonValue;
+  CJoystickManager::Get().StateStore().SetButton(m_stateSlot, buttonIndex, buttonValue);
 }
 
 void CJoystick::SetHatValue(unsigned int hatIndex, JOYSTICK_STATE_HAT hatValue)
 {
   Activate();
 
-  if (hatIndex < m_stateBuffer.hats.size())
-    m_stateBuffer.hats[hatIndex] = hatValue;
+  CJoystickManager::Get().StateStore().SetHat(m_stateSlot, hatIndex, hatValue);
 }
 
 void CJoystick::SetAxisValue(unsigned int axisIndex, JOYSTICK_STATE_AXIS axisValue)
 {
   Activate();
 
-  axisValue = CONSTRAIN(-1.0f, axisValue, 1.0f);
+  axisValue = ScaleDeadzone(CONSTRAIN(-1.0f, axisValue, 1.0f));
 
-  if (axisIndex < m_stateBuffer.axes.size())
-  {
-    m_stateBuffer.axes[axisIndex].state = axisValue;
-    m_stateBuffer.axes[axisIndex].bSeen = true;
-  }
+  CJoystickManager::Get().StateStore().SetAxis(m_stateSlot, axisIndex, axisValue);
 }
 
 void CJoystick::SetAxisValue(unsigned int axisIndex, long value, long maxAxisAmount)
@@ -231,3 +184,20 @@ float CJoystick::NormalizeAxis(long value, long maxAxisAmount)
 {
   return 1.0f * CONSTRAIN(-maxAxisAmount, value, maxAxisAmount) / maxAxisAmount;
 }
+
+float CJoystick::ScaleDeadzone(float value)
+{
+  const float deadzone = CSettings::Get().AxisDeadzone();
+
+  if (deadzone <= 0.0f)
+    return value;
+
+  if (-deadzone < value && value < deadzone)
+    return 0.0f;
+
+  // Rescale the remaining range so that the output is still continuous
+  if (value > 0.0f)
+    return (value - deadzone) / (1.0f - deadzone);
+  else
+    return (value + deadzone) / (1.0f - deadzone);
+}
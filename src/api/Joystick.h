@@ -20,6 +20,7 @@
 #pragma once
 
 #include "JoystickTypes.h"
+#include "buttonmapper/ButtonMapTypes.h"
 
 #include <kodi/addon-instance/PeripheralUtils.h>
 
@@ -70,22 +71,31 @@ namespace JOYSTICK
      */
     int64_t LastEventTimeMs(void) const { return m_lastEventTimeMs; }
 
+    /*!
+     * The joystick's slice in the joystick manager's state store, or -1 if
+     * the joystick isn't initialized
+     */
+    int StateSlot(void) const { return m_stateSlot; }
+
     /*!
      * Initialize the joystick object. Joystick will be initialized before the
-     * first call to GetEvents().
+     * first call to Update().
      */
     virtual bool Initialize(void);
 
     /*!
-     * Deinitialize the joystick object. GetEvents() will not be called after
+     * Deinitialize the joystick object. Update() will not be called after
      * deinitialization.
      */
     virtual void Deinitialize(void);
 
     /*!
-     * Get events that have occurred since the last call to GetEvents()
+     * Scan for events and stage them in the joystick manager's state store,
+     * which reports them for all joysticks at once
+     *
+     * \return True if the joystick was scanned
      */
-    virtual bool GetEvents(std::vector<kodi::addon::PeripheralEvent>& events);
+    bool Update(void);
 
     /*!
      * Send an event to a joystick
@@ -94,14 +104,32 @@ namespace JOYSTICK
 
     /*!
      * Process events sent to the joystick
+     *
+     * Called from the force-feedback worker, not from the input thread.
+     *
+     * \return True if output is still pending and this should be called again
      */
-    virtual void ProcessEvents() { }
+    virtual bool ProcessEvents() { return false; }
 
     /*!
      * Tries to power off the joystick.
      */
     virtual void PowerOff() { }
 
+    /*!
+     * File descriptor that becomes readable when input is available, or -1
+     * if the joystick can only be polled
+     */
+    virtual int GetInputFd(void) const { return -1; }
+
+    /*!
+     * Get the axis layout that button maps were saved with before hats were
+     * reported as hats
+     *
+     * \return False if the joystick never reported hats as axes
+     */
+    virtual bool GetLegacyAxisLayout(LegacyAxisLayout& layout) const { return false; }
+
   protected:
     /*!
      * Implemented by derived class to scan for events
@@ -118,33 +146,20 @@ namespace JOYSTICK
   private:
     void Activate();
 
-    void GetButtonEvents(std::vector<kodi::addon::PeripheralEvent>& events);
-    void GetHatEvents(std::vector<kodi::addon::PeripheralEvent>& events);
-    void GetAxisEvents(std::vector<kodi::addon::PeripheralEvent>& events);
-
     void UpdateTimers(void);
 
     /*!
      * Normalize the axis to the closed interval [-1.0, 1.0].
      */
     static float NormalizeAxis(long value, long maxAxisAmount);
+
+    /*!
+     * Apply the deadzone from the add-on settings, if any, and rescale the
+     * rest of the axis to [-1.0, 1.0].
+     */
     static float ScaleDeadzone(float value);
 
-    struct JoystickAxis
-    {
-      JOYSTICK_STATE_AXIS state = 0.0f;
-      bool bSeen = false;
-    };
-
-    struct JoystickState
-    {
-      std::vector<JOYSTICK_STATE_BUTTON> buttons;
-      std::vector<JOYSTICK_STATE_HAT>    hats;
-      std::vector<JoystickAxis>          axes;
-    };
-
-    JoystickState                     m_state;
-    JoystickState                     m_stateBuffer;
+    int                               m_stateSlot; // Slice in the state store, or -1
     int64_t                           m_discoverTimeMs;
     int64_t                           m_activateTimeMs;
     int64_t                           m_firstEventTimeMs;
@@ -42,8 +42,11 @@
 #if defined(HAVE_UDEV)
   #include "udev/JoystickInterfaceUdev.h"
 #endif
+#include "replay/JoystickInterfaceReplay.h"
+#include "virtual/JoystickInterfaceVirtual.h"
 
 #include "log/Log.h"
+#include "log/Trace.h"
 #include "settings/Settings.h"
 #include "utils/CommonMacros.h"
 
@@ -93,8 +96,10 @@ namespace JOYSTICK
 
 CJoystickManager::CJoystickManager(void)
   : m_scanner(NULL),
+    m_scanGeneration(0),
     m_nextJoystickIndex(0),
-    m_bChanged(false)
+    m_bChanged(false),
+    m_bScanNeeded(true)
 {
 }
 
@@ -133,6 +138,12 @@ const std::vector<EJoystickInterface>& CJoystickManager::GetSupportedInterfaces(
 #if defined(HAVE_COCOA)
     supportedInterfaces.push_back(EJoystickInterface::COCOA);
 #endif
+
+    // Test interfaces, only present when requested
+    if (CJoystickInterfaceReplay::IsEnabled())
+      supportedInterfaces.push_back(EJoystickInterface::REPLAY);
+    if (CJoystickInterfaceVirtual::IsEnabled())
+      supportedInterfaces.push_back(EJoystickInterface::VIRTUAL);
   }
 
   return supportedInterfaces;
@@ -160,6 +171,8 @@ IJoystickInterface* CJoystickManager::CreateInterface(EJoystickInterface iface)
 #if defined(HAVE_XINPUT)
   case EJoystickInterface::XINPUT: return new CJoystickInterfaceXInput;
 #endif
+  case EJoystickInterface::REPLAY: return new CJoystickInterfaceReplay;
+  case EJoystickInterface::VIRTUAL: return new CJoystickInterfaceVirtual;
   default:
     break;
   }
@@ -185,14 +198,67 @@ bool CJoystickManager::Initialize(IScannerCallback* scanner)
   if (m_interfaces.empty())
     dsyslog("No joystick APIs in use");
 
+#if defined(HAVE_IO_URING)
+  m_inputRing.Initialize();
+#endif
+
+  m_forceFeedbackWorker.Start();
+  m_scanScheduler.Start(m_scanner);
+
+#if defined(HAVE_STATE_MIRROR)
+  if (CStateMirror::IsEnabled())
+    m_stateMirror.Open();
+#endif
+#if defined(HAVE_EVENT_TAP)
+  if (CEventTap::IsEnabled())
+    m_eventTap.Start();
+#endif
+#if defined(HAVE_INPUT_READER)
+  if (CInputReader::IsEnabled())
+    m_inputReader.Start(CInputReader::GetProfile());
+#endif
+
+  // Test interfaces aren't controlled by a setting, so enable them when present
+  if (HasInterface(EJoystickInterface::REPLAY))
+    SetEnabled(EJoystickInterface::REPLAY, true);
+  if (HasInterface(EJoystickInterface::VIRTUAL))
+    SetEnabled(EJoystickInterface::VIRTUAL, true);
+
   return true;
 }
 
 void CJoystickManager::Deinitialize(void)
 {
+#if defined(HAVE_INPUT_READER)
+  // Stop reading before the devices go away
+  m_inputReader.Stop();
+#endif
+
+  // Stop output before the joysticks are closed
+  m_forceFeedbackWorker.Stop();
+  m_scanScheduler.Stop();
+#if defined(HAVE_EVENT_TAP)
+  m_eventTap.Stop();
+#endif
+
   {
     CLockObject lock(m_joystickMutex);
+#if defined(HAVE_STATE_MIRROR)
+    m_stateMirror.Close();
+#endif
     m_joysticks.clear();
+    m_scanResults.clear();
+    m_scanGeneration++; // Results converted by the add-on are stale too
+#if defined(HAVE_IO_URING)
+    m_inputRing.Deinitialize();
+#endif
+  }
+
+  {
+    CLockObject lock(m_changedMutex);
+
+    // Results cached before a re-initialization must not be handed out
+    m_bScanNeeded = true;
   }
 
   {
@@ -278,40 +344,94 @@ bool CJoystickManager::IsEnabled(IJoystickInterface* iface)
   return m_enabledInterfaces.find(iface) != m_enabledInterfaces.end();
 }
 
-bool CJoystickManager::PerformJoystickScan(JoystickVector& joysticks)
+bool CJoystickManager::PerformJoystickScan(JoystickVector& joysticks, unsigned int& generation, JoystickVector* newJoysticks /* = nullptr */)
 {
+  TRACE_SCOPE("CJoystickManager::PerformJoystickScan");
+
+  bool bScanNeeded;
+  {
+    CLockObject lock(m_changedMutex);
+    bScanNeeded = m_bScanNeeded;
+    m_bScanNeeded = false;
+  }
+
   JoystickVector scanResults;
+  JoystickVector initializedJoysticks;
   {
     CLockObject lock(m_interfacesMutex);
-    // Scan for joysticks (this can take a while, don't block)
+
     for (auto pInterface : m_enabledInterfaces)
-      pInterface->ScanForJoysticks(scanResults);
+    {
+      if (pInterface->NeedsScan())
+        bScanNeeded = true;
+    }
+
+    // Scan for joysticks (this can take a while, don't block)
+    if (bScanNeeded)
+    {
+      for (auto pInterface : m_enabledInterfaces)
+        pInterface->ScanForJoysticks(scanResults);
+    }
+  }
+
+  // Open new joysticks without holding the joystick lock, which the input
+  // reader may be waiting for at real-time priority
+  if (bScanNeeded)
+  {
+    JoystickVector currentJoysticks;
+    {
+      CLockObject lock(m_joystickMutex);
+      currentJoysticks = m_joysticks;
+    }
+
+    for (const JoystickPtr& joystick : scanResults)
+    {
+      if (std::find_if(currentJoysticks.begin(), currentJoysticks.end(), ScanResultEqual(joystick)) == currentJoysticks.end())
+      {
+        if (joystick->Initialize())
+          initializedJoysticks.push_back(joystick);
+      }
+    }
   }
 
+  // Removed joysticks are closed after the lock is released
+  JoystickVector removedJoysticks;
+
   CLockObject lock(m_joystickMutex);
 
+  // Nothing has changed since the last scan
+  if (!bScanNeeded)
+  {
+    joysticks = m_scanResults;
+    generation = m_scanGeneration;
+    return true;
+  }
+
   // Unregister removed joysticks
   for (int i = (int)m_joysticks.size() - 1; i >= 0; i--)
   {
     if (std::find_if(scanResults.begin(), scanResults.end(), ScanResultEqual(m_joysticks.at(i))) == scanResults.end())
+    {
+      removedJoysticks.push_back(m_joysticks.at(i));
       m_joysticks.erase(m_joysticks.begin() + i);
+    }
   }
 
-  // Register new joysticks
-  for (JoystickVector::iterator itJoystick = scanResults.begin(); itJoystick != scanResults.end(); ++itJoystick)
+  // Register new joysticks, unless a concurrent scan already has
+  for (JoystickVector::iterator itJoystick = initializedJoysticks.begin(); itJoystick != initializedJoysticks.end(); ++itJoystick)
   {
     if (std::find_if(m_joysticks.begin(), m_joysticks.end(), ScanResultEqual(*itJoystick)) == m_joysticks.end())
     {
-      if ((*itJoystick)->Initialize())
-      {
-        (*itJoystick)->SetIndex(m_nextJoystickIndex++);
+      (*itJoystick)->SetIndex(m_nextJoystickIndex++);
 
-        isyslog("Initialized joystick %u: \"%s\", axes: %u, hats: %u, buttons: %u",
-                (*itJoystick)->Index(), (*itJoystick)->Name().c_str(),
-                (*itJoystick)->AxisCount(), (*itJoystick)->HatCount(), (*itJoystick)->ButtonCount());
+      isyslog("Initialized joystick %u: \"%s\", axes: %u, hats: %u, buttons: %u",
+              (*itJoystick)->Index(), (*itJoystick)->Name().c_str(),
+              (*itJoystick)->AxisCount(), (*itJoystick)->HatCount(), (*itJoystick)->ButtonCount());
 
-        m_joysticks.push_back(*itJoystick);
-      }
+      m_joysticks.push_back(*itJoystick);
+
+      if (newJoysticks != nullptr)
+        newJoysticks->push_back(*itJoystick);
     }
   }
 
@@ -325,6 +445,25 @@ bool CJoystickManager::PerformJoystickScan(JoystickVector& joysticks)
              !joystick->IsActive();
     }), joysticks.end());
 
+  if (joysticks != m_scanResults)
+  {
+    removedJoysticks.insert(removedJoysticks.end(), m_scanResults.begin(), m_scanResults.end());
+    m_scanResults = joysticks;
+    m_scanGeneration++;
+
+#if defined(HAVE_STATE_MIRROR)
+    m_stateMirror.SetLayout(m_scanResults, m_stateStore);
+#endif
+  }
+
+  generation = m_scanGeneration;
+
+#if defined(HAVE_INPUT_READER)
+  // Let the reader wait on the new set of devices
+  if (!removedJoysticks.empty() || !initializedJoysticks.empty())
+    m_inputReader.Wake();
+#endif
+
   return true;
 }
 
@@ -361,14 +500,84 @@ JoystickVector CJoystickManager::GetJoysticks(const kodi::addon::Joystick& joyst
 
 bool CJoystickManager::GetEvents(std::vector<kodi::addon::PeripheralEvent>& events)
 {
+  {
+    CLockObject lock(m_interfacesMutex);
+
+    // Interfaces that dispatch input while polling update joystick state,
+    // which the input reader also updates
+    CLockObject joystickLock(m_joystickMutex);
+
+    for (auto pInterface : m_enabledInterfaces)
+      pInterface->PollEvents();
+  }
+
   CLockObject lock(m_joystickMutex);
 
-  for (JoystickVector::iterator it = m_joysticks.begin(); it != m_joysticks.end(); ++it)
-    (*it)->GetEvents(events);
+#if defined(HAVE_EVENT_TAP)
+  const auto firstEvent = events.size();
+#endif
+
+#if defined(HAVE_INPUT_READER)
+  // The reader thread has already staged the input
+  if (!m_inputReader.IsReading())
+    ReadInput();
+#else
+  ReadInput();
+#endif
+
+#if defined(HAVE_STATE_MIRROR)
+  // Only republish when something moved
+  if (m_stateStore.GetEvents(events))
+    m_stateMirror.Publish(m_stateStore);
+#else
+  m_stateStore.GetEvents(events);
+#endif
+
+#if defined(HAVE_EVENT_TAP)
+  m_eventTap.Post(events, firstEvent);
+#endif
 
   return true;
 }
 
+void CJoystickManager::ReadInput(void)
+{
+  CLockObject lock(m_joystickMutex);
+
+#if defined(HAVE_IO_URING)
+  // Collect input for all devices at once before they are scanned
+  m_inputRing.Harvest();
+#endif
+
+  for (JoystickVector::iterator it = m_joysticks.begin(); it != m_joysticks.end(); ++it)
+    (*it)->Update();
+}
+
+bool CJoystickManager::GetInputFds(std::vector<int>& fds) const
+{
+  bool bAllWaitable = true;
+
+#if defined(HAVE_IO_URING)
+  // Reads completed by the ring no longer show up on the device nodes
+  const int ringFd = m_inputRing.GetEventFd();
+  if (ringFd >= 0)
+    fds.push_back(ringFd);
+#endif
+
+  CLockObject lock(m_joystickMutex);
+
+  for (const auto& joystick : m_joysticks)
+  {
+    const int fd = joystick->GetInputFd();
+    if (fd >= 0)
+      fds.push_back(fd);
+    else
+      bAllWaitable = false;
+  }
+
+  return bAllWaitable;
+}
+
 bool CJoystickManager::SendEvent(const kodi::addon::PeripheralEvent& event)
 {
   bool bHandled = false;
@@ -385,21 +594,37 @@ bool CJoystickManager::SendEvent(const kodi::addon::PeripheralEvent& event)
     }
   }
 
+  if (bHandled)
+    m_forceFeedbackWorker.Notify();
+
   return bHandled;
 }
 
-void CJoystickManager::ProcessEvents()
+bool CJoystickManager::ProcessEvents()
 {
-  CLockObject lock(m_joystickMutex);
+  JoystickVector joysticks;
+  {
+    CLockObject lock(m_joystickMutex);
+    joysticks = m_joysticks;
+  }
 
-  for (const JoystickPtr& joystick : m_joysticks)
-    joystick->ProcessEvents();
+  // Joysticks are kept alive by the copy if they are removed meanwhile
+  bool bPending = false;
+  for (const JoystickPtr& joystick : joysticks)
+  {
+    if (joystick->ProcessEvents())
+      bPending = true;
+  }
+
+  return bPending;
 }
 
 void CJoystickManager::SetChanged(bool bChanged)
 {
   CLockObject lock(m_changedMutex);
   m_bChanged = bChanged;
+  if (bChanged)
+    m_bScanNeeded = true;
 }
 
 void CJoystickManager::TriggerScan(void)
@@ -411,8 +636,9 @@ void CJoystickManager::TriggerScan(void)
     m_bChanged = false;
   }
 
-  if (bChanged && m_scanner)
-    m_scanner->TriggerScan();
+  // Bursts of changes are merged into a single scan
+  if (bChanged)
+    m_scanScheduler.RequestScan();
 }
 
 const ButtonMap& CJoystickManager::GetButtonMap(const std::string& provider)
@@ -19,7 +19,22 @@
  */
 #pragma once
 
+#include "ForceFeedbackWorker.h"
+#include "JoystickStateStore.h"
 #include "JoystickTypes.h"
+#include "ScanScheduler.h"
+#if defined(HAVE_STATE_MIRROR)
+  #include "mirror/StateMirror.h"
+#endif
+#if defined(HAVE_EVENT_TAP)
+  #include "tap/EventTap.h"
+#endif
+#if defined(HAVE_IO_URING)
+  #include "uring/InputRing.h"
+#endif
+#if defined(HAVE_INPUT_READER)
+  #include "InputReader.h"
+#endif
 #include "buttonmapper/ButtonMapTypes.h"
 
 #include <kodi/addon-instance/PeripheralUtils.h>
@@ -107,11 +122,18 @@ namespace JOYSTICK
     /*!
      * \brief Scan the available interfaces for joysticks
      *
+     * If no change has been announced and no interface needs probing, the
+     * previous results are returned without scanning.
+     *
      * \param joysticks The discovered joysticks; must be deallocated
+     * \param generation Incremented whenever the results differ from the
+     *                   previous scan
+     * \param newJoysticks If not null, receives the joysticks that were
+     *                     registered by this scan
      *
      * \return true if the scan succeeded (even if there are no joysticks)
      */
-    bool PerformJoystickScan(JoystickVector& joysticks);
+    bool PerformJoystickScan(JoystickVector& joysticks, unsigned int& generation, JoystickVector* newJoysticks = nullptr);
 
     JoystickPtr GetJoystick(unsigned int index) const;
 
@@ -122,9 +144,39 @@ namespace JOYSTICK
     */
     bool GetEvents(std::vector<kodi::addon::PeripheralEvent>& events);
 
+    /*!
+     * \brief Read input from all joysticks into the state store
+     *
+     * Called by GetEvents(), or by the input reader when it is running.
+     */
+    void ReadInput(void);
+
+    /*!
+     * \brief Get the fds that become readable when joysticks have input
+     *
+     * \return False if some joysticks can't be waited on and must be polled
+     */
+    bool GetInputFds(std::vector<int>& fds) const;
+
+    /*!
+     * \brief Input state of all joysticks, one slice per joystick
+     */
+    CJoystickStateStore& StateStore(void) { return m_stateStore; }
+
+#if defined(HAVE_IO_URING)
+    /*!
+     * \brief Ring used by device nodes to read input, harvested once per
+     *        call to GetEvents()
+     */
+    CInputRing& InputRing(void) { return m_inputRing; }
+#endif
+
     /*!
      * \brief Send an event to a joystick
      *
+     * Output is only posted to the joystick. It is applied asynchronously by
+     * the force-feedback worker.
+     *
      * \param event The event
      *
      * \return True if the event was handled
@@ -133,8 +185,13 @@ namespace JOYSTICK
 
     /*!
      * \brief Process events that have arrived since the last call to ProcessEvents()
+     *
+     * Called by the force-feedback worker. Output I/O is performed without
+     * holding the joystick lock.
+     *
+     * \return True if a joystick has output pending that should be retried
      */
-    void ProcessEvents();
+    bool ProcessEvents();
 
     /*!
      * \brief Set the flag for changed interfaces
@@ -159,11 +216,29 @@ namespace JOYSTICK
     IScannerCallback*                m_scanner;
     std::vector<IJoystickInterface*> m_interfaces;
     std::set<IJoystickInterface*>    m_enabledInterfaces;
+    CJoystickStateStore              m_stateStore; // Outlives the joysticks below
+#if defined(HAVE_IO_URING)
+    CInputRing                       m_inputRing; // Outlives the joysticks below
+#endif
     JoystickVector                   m_joysticks;
+    JoystickVector                   m_scanResults; // Filtered result of the last scan
+    unsigned int                     m_scanGeneration;
     unsigned int                     m_nextJoystickIndex;
     bool                             m_bChanged;
+    bool                             m_bScanNeeded; // Reset by scanning, unlike m_bChanged
     mutable P8PLATFORM::CMutex       m_changedMutex;
     mutable P8PLATFORM::CMutex         m_interfacesMutex;
     mutable P8PLATFORM::CMutex         m_joystickMutex;
+    CForceFeedbackWorker             m_forceFeedbackWorker;
+    CScanScheduler                   m_scanScheduler;
+#if defined(HAVE_STATE_MIRROR)
+    CStateMirror                     m_stateMirror;
+#endif
+#if defined(HAVE_EVENT_TAP)
+    CEventTap                        m_eventTap;
+#endif
+#if defined(HAVE_INPUT_READER)
+    CInputReader                     m_inputReader;
+#endif
   };
 }
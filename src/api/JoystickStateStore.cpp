@@ -0,0 +1,279 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "JoystickStateStore.h"
+
+#include <string.h>
+
+using namespace JOYSTICK;
+using namespace P8PLATFORM;
+
+#define BUTTONS_PER_WORD  32
+#define AXIS_ALIGNMENT    4 // Axis slices are padded to a multiple of this many floats
+
+int CJoystickStateStore::Allocate(unsigned int buttonCount, unsigned int hatCount, unsigned int axisCount)
+{
+  CLockObject lock(m_mutex);
+
+  Slice slice = { };
+
+  slice.bInUse = true;
+  slice.buttonCount = buttonCount;
+  slice.buttonWord = m_buttons.size();
+  slice.hatCount = hatCount;
+  slice.hatOffset = m_hats.size();
+  slice.axisCount = axisCount;
+  slice.axisOffset = m_axes.size();
+  slice.axisSeenWord = m_axesSeen.size();
+
+  m_buttons.resize(m_buttons.size() + WordCount(buttonCount), 0);
+  m_buttonsStaged.resize(m_buttons.size(), 0);
+  m_hats.resize(m_hats.size() + hatCount, JOYSTICK_STATE_HAT_UNPRESSED);
+  m_hatsStaged.resize(m_hats.size(), JOYSTICK_STATE_HAT_UNPRESSED);
+  m_axes.resize(m_axes.size() + AlignedAxisCount(axisCount), 0.0f);
+  m_axesSeen.resize(m_axesSeen.size() + WordCount(axisCount), 0);
+
+  // Reuse the first free slot
+  for (unsigned int i = 0; i < m_slices.size(); i++)
+  {
+    if (!m_slices[i].bInUse)
+    {
+      m_slices[i] = slice;
+      return i;
+    }
+  }
+
+  m_slices.push_back(slice);
+
+  return m_slices.size() - 1;
+}
+
+void CJoystickStateStore::Release(int slot)
+{
+  CLockObject lock(m_mutex);
+
+  Slice* slice = GetSlice(slot);
+  if (slice == nullptr)
+    return;
+
+  const unsigned int buttonWords = WordCount(slice->buttonCount);
+  const unsigned int axes = AlignedAxisCount(slice->axisCount);
+  const unsigned int axisSeenWords = WordCount(slice->axisCount);
+
+  m_buttons.erase(m_buttons.begin() + slice->buttonWord, m_buttons.begin() + slice->buttonWord + buttonWords);
+  m_buttonsStaged.erase(m_buttonsStaged.begin() + slice->buttonWord, m_buttonsStaged.begin() + slice->buttonWord + buttonWords);
+  m_hats.erase(m_hats.begin() + slice->hatOffset, m_hats.begin() + slice->hatOffset + slice->hatCount);
+  m_hatsStaged.erase(m_hatsStaged.begin() + slice->hatOffset, m_hatsStaged.begin() + slice->hatOffset + slice->hatCount);
+  m_axes.erase(m_axes.begin() + slice->axisOffset, m_axes.begin() + slice->axisOffset + axes);
+  m_axesSeen.erase(m_axesSeen.begin() + slice->axisSeenWord, m_axesSeen.begin() + slice->axisSeenWord + axisSeenWords);
+
+  // Close the gap in the slices behind this one
+  for (Slice& other : m_slices)
+  {
+    if (!other.bInUse)
+      continue;
+
+    if (other.buttonWord > slice->buttonWord)
+      other.buttonWord -= buttonWords;
+    if (other.hatOffset > slice->hatOffset)
+      other.hatOffset -= slice->hatCount;
+    if (other.axisOffset > slice->axisOffset)
+      other.axisOffset -= axes;
+    if (other.axisSeenWord > slice->axisSeenWord)
+      other.axisSeenWord -= axisSeenWords;
+  }
+
+  slice->bInUse = false;
+
+  while (!m_slices.empty() && !m_slices.back().bInUse)
+    m_slices.pop_back();
+}
+
+void CJoystickStateStore::SetButton(int slot, unsigned int buttonIndex, JOYSTICK_STATE_BUTTON buttonValue)
+{
+  CLockObject lock(m_mutex);
+
+  const Slice* slice = GetSlice(slot);
+  if (slice == nullptr || buttonIndex >= slice->buttonCount)
+    return;
+
+  uint32_t& word = m_buttonsStaged[slice->buttonWord + buttonIndex / BUTTONS_PER_WORD];
+  const uint32_t mask = 1u << (buttonIndex % BUTTONS_PER_WORD);
+
+  if (buttonValue == JOYSTICK_STATE_BUTTON_PRESSED)
+    word |= mask;
+  else
+    word &= ~mask;
+}
+
+void CJoystickStateStore::SetHat(int slot, unsigned int hatIndex, JOYSTICK_STATE_HAT hatValue)
+{
+  CLockObject lock(m_mutex);
+
+  const Slice* slice = GetSlice(slot);
+  if (slice == nullptr || hatIndex >= slice->hatCount)
+    return;
+
+  m_hatsStaged[slice->hatOffset + hatIndex] = static_cast<uint8_t>(hatValue);
+}
+
+void CJoystickStateStore::SetAxis(int slot, unsigned int axisIndex, JOYSTICK_STATE_AXIS axisValue)
+{
+  CLockObject lock(m_mutex);
+
+  const Slice* slice = GetSlice(slot);
+  if (slice == nullptr || axisIndex >= slice->axisCount)
+    return;
+
+  float& axis = m_axes[slice->axisOffset + axisIndex];
+  if (axis != axisValue)
+  {
+    axis = axisValue;
+    m_bAxesChanged = true;
+  }
+
+  m_axesSeen[slice->axisSeenWord + axisIndex / BUTTONS_PER_WORD] |= 1u << (axisIndex % BUTTONS_PER_WORD);
+}
+
+void CJoystickStateStore::Stage(int slot, unsigned int joystickIndex)
+{
+  CLockObject lock(m_mutex);
+
+  Slice* slice = GetSlice(slot);
+  if (slice == nullptr)
+    return;
+
+  slice->bStaged = true;
+  slice->joystickIndex = joystickIndex;
+}
+
+bool CJoystickStateStore::GetEvents(std::vector<kodi::addon::PeripheralEvent>& events)
+{
+  CLockObject lock(m_mutex);
+
+  bool bChanged = m_bAxesChanged;
+  m_bAxesChanged = false;
+
+  for (Slice& slice : m_slices)
+  {
+    if (!slice.bInUse || !slice.bStaged)
+      continue;
+
+    slice.bStaged = false;
+
+    // Buttons: one comparison per 32 buttons
+    const unsigned int buttonWords = WordCount(slice.buttonCount);
+    for (unsigned int w = 0; w < buttonWords; w++)
+    {
+      const uint32_t staged = m_buttonsStaged[slice.buttonWord + w];
+      uint32_t changed = staged ^ m_buttons[slice.buttonWord + w];
+
+      if (changed != 0)
+        bChanged = true;
+
+      for (unsigned int bit = 0; changed != 0; bit++, changed >>= 1)
+      {
+        if (changed & 1)
+        {
+          const bool bPressed = (staged & (1u << bit)) != 0;
+          events.push_back(kodi::addon::PeripheralEvent(slice.joystickIndex, w * BUTTONS_PER_WORD + bit,
+            bPressed ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED));
+        }
+      }
+
+      m_buttons[slice.buttonWord + w] = staged;
+    }
+
+    // Hats: skip the slice if nothing moved
+    const uint8_t* hatsStaged = m_hatsStaged.data() + slice.hatOffset;
+    uint8_t* hats = m_hats.data() + slice.hatOffset;
+    if (memcmp(hats, hatsStaged, slice.hatCount) != 0)
+    {
+      bChanged = true;
+
+      for (unsigned int i = 0; i < slice.hatCount; i++)
+      {
+        if (hats[i] != hatsStaged[i])
+          events.push_back(kodi::addon::PeripheralEvent(slice.joystickIndex, i, static_cast<JOYSTICK_STATE_HAT>(hatsStaged[i])));
+      }
+
+      memcpy(hats, hatsStaged, slice.hatCount);
+    }
+
+    // Axes are reported every poll once they have been seen
+    const unsigned int axisSeenWords = WordCount(slice.axisCount);
+    for (unsigned int w = 0; w < axisSeenWords; w++)
+    {
+      uint32_t seen = m_axesSeen[slice.axisSeenWord + w];
+
+      for (unsigned int bit = 0; seen != 0; bit++, seen >>= 1)
+      {
+        if (seen & 1)
+        {
+          const unsigned int axisIndex = w * BUTTONS_PER_WORD + bit;
+          events.push_back(kodi::addon::PeripheralEvent(slice.joystickIndex, axisIndex, m_axes[slice.axisOffset + axisIndex]));
+        }
+      }
+    }
+  }
+
+  return bChanged;
+}
+
+bool CJoystickStateStore::ReadState(int slot, uint32_t* buttons, uint8_t* hats, float* axes) const
+{
+  CLockObject lock(m_mutex);
+
+  const Slice* slice = GetSlice(slot);
+  if (slice == nullptr)
+    return false;
+
+  memcpy(buttons, m_buttons.data() + slice->buttonWord, WordCount(slice->buttonCount) * sizeof(uint32_t));
+  memcpy(hats, m_hats.data() + slice->hatOffset, slice->hatCount);
+  memcpy(axes, m_axes.data() + slice->axisOffset, slice->axisCount * sizeof(float));
+
+  return true;
+}
+
+CJoystickStateStore::Slice* CJoystickStateStore::GetSlice(int slot)
+{
+  if (0 <= slot && slot < (int)m_slices.size() && m_slices[slot].bInUse)
+    return &m_slices[slot];
+
+  return nullptr;
+}
+
+const CJoystickStateStore::Slice* CJoystickStateStore::GetSlice(int slot) const
+{
+  if (0 <= slot && slot < (int)m_slices.size() && m_slices[slot].bInUse)
+    return &m_slices[slot];
+
+  return nullptr;
+}
+
+unsigned int CJoystickStateStore::WordCount(unsigned int bitCount)
+{
+  return (bitCount + BUTTONS_PER_WORD - 1) / BUTTONS_PER_WORD;
+}
+
+unsigned int CJoystickStateStore::AlignedAxisCount(unsigned int axisCount)
+{
+  return (axisCount + AXIS_ALIGNMENT - 1) / AXIS_ALIGNMENT * AXIS_ALIGNMENT;
+}
@@ -0,0 +1,123 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <kodi/addon-instance/PeripheralUtils.h>
+#include "p8-platform/threads/mutex.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace JOYSTICK
+{
+  /*!
+   * \brief Input state of all joysticks, stored as a structure of arrays
+   *
+   * Each joystick owns a slice of every array. Buttons and seen-axis flags
+   * are bit-packed into 32-bit words, hats are one byte each and axis slices
+   * are padded to a multiple of four floats. A poll compares the staged state against
+   * the committed state a word at a time, so the whole input state of
+   * several controllers fits in a few cache lines.
+   *
+   * Slots are stable for the lifetime of a joystick. Releasing a slot
+   * compacts the arrays.
+   */
+  class CJoystickStateStore
+  {
+  public:
+    /*!
+     * \brief Allocate a slice for a joystick
+     *
+     * \return The slot of the slice, used for all other calls
+     */
+    int Allocate(unsigned int buttonCount, unsigned int hatCount, unsigned int axisCount);
+
+    /*!
+     * \brief Release the slice of a joystick
+     */
+    void Release(int slot);
+
+    /*!
+     * \brief Stage a new value, to be reported by the next GetEvents()
+     */
+    void SetButton(int slot, unsigned int buttonIndex, JOYSTICK_STATE_BUTTON buttonValue);
+    void SetHat(int slot, unsigned int hatIndex, JOYSTICK_STATE_HAT hatValue);
+    void SetAxis(int slot, unsigned int axisIndex, JOYSTICK_STATE_AXIS axisValue);
+
+    /*!
+     * \brief Mark a slice as scanned, so that GetEvents() reports it
+     *
+     * \param slot The slot of the joystick
+     * \param joystickIndex The index reported in the joystick's events
+     */
+    void Stage(int slot, unsigned int joystickIndex);
+
+    /*!
+     * \brief Get events for all slices staged since the last call, and commit
+     *        their state
+     *
+     * \return True if a button or hat changed or an axis moved
+     */
+    bool GetEvents(std::vector<kodi::addon::PeripheralEvent>& events);
+
+    /*!
+     * \brief Copy the committed state of a slice
+     *
+     * \param slot The slot of the joystick
+     * \param buttons Receives the bit-packed buttons, one bit per button
+     * \param hats Receives one byte per hat
+     * \param axes Receives one float per axis
+     *
+     * \return False if the slot is not in use
+     */
+    bool ReadState(int slot, uint32_t* buttons, uint8_t* hats, float* axes) const;
+
+  private:
+    struct Slice
+    {
+      bool         bInUse;
+      bool         bStaged;
+      unsigned int joystickIndex;
+      unsigned int buttonCount;
+      unsigned int buttonWord;   // Offset into m_buttons/m_buttonsStaged
+      unsigned int hatCount;
+      unsigned int hatOffset;    // Offset into m_hats/m_hatsStaged
+      unsigned int axisCount;
+      unsigned int axisOffset;   // Offset into m_axes
+      unsigned int axisSeenWord; // Offset into m_axesSeen
+    };
+
+    Slice* GetSlice(int slot);
+    const Slice* GetSlice(int slot) const;
+
+    static unsigned int WordCount(unsigned int bitCount);
+    static unsigned int AlignedAxisCount(unsigned int axisCount);
+
+    std::vector<Slice>         m_slices;
+    std::vector<uint32_t>      m_buttons;       // Committed, 1 bit per button
+    std::vector<uint32_t>      m_buttonsStaged;
+    std::vector<uint8_t>       m_hats;          // Committed, 1 byte per hat
+    std::vector<uint8_t>       m_hatsStaged;
+    std::vector<float>         m_axes;          // Reported every poll once seen
+    std::vector<uint32_t>      m_axesSeen;
+    bool                       m_bAxesChanged = false; // Since the last GetEvents()
+    mutable P8PLATFORM::CMutex m_mutex;
+  };
+}
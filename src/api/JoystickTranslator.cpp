@@ -46,6 +46,10 @@ namespace JOYSTICK
       EJoystickInterface::LINUX,
       "linux",
     },
+    {
+      EJoystickInterface::REPLAY,
+      "replay",
+    },
     {
       EJoystickInterface::SDL,
       "sdl",
@@ -54,6 +58,10 @@ namespace JOYSTICK
       EJoystickInterface::UDEV,
       "udev",
     },
+    {
+      EJoystickInterface::VIRTUAL,
+      "virtual",
+    },
     {
       EJoystickInterface::XINPUT,
       "xinput",
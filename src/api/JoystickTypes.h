@@ -35,8 +35,10 @@ namespace JOYSTICK
     COCOA,
     DIRECTINPUT,
     LINUX,
+    REPLAY,
     SDL,
     UDEV,
+    VIRTUAL,
     XINPUT,
   };
 
@@ -22,6 +22,8 @@
 #include "JoystickTranslator.h"
 #include "JoystickTypes.h"
 
+#include <stdint.h>
+
 using namespace JOYSTICK;
 
 bool CJoystickUtils::IsGhostJoystick(const CJoystick& joystick)
@@ -40,3 +42,22 @@ bool CJoystickUtils::IsGhostJoystick(const CJoystick& joystick)
 
   return false;
 }
+
+JOYSTICK_STATE_HAT CJoystickUtils::UpdateHatAxis(JOYSTICK_STATE_HAT hat, bool bVertical, int value, int minimum, int maximum)
+{
+  const unsigned int negative = bVertical ? JOYSTICK_STATE_HAT_UP : JOYSTICK_STATE_HAT_LEFT;
+  const unsigned int positive = bVertical ? JOYSTICK_STATE_HAT_DOWN : JOYSTICK_STATE_HAT_RIGHT;
+
+  unsigned int state = hat & ~(negative | positive);
+
+  // Compare against the midpoint of the range, doubled to stay in integers
+  const int64_t doubledValue = 2 * static_cast<int64_t>(value);
+  const int64_t doubledCenter = static_cast<int64_t>(minimum) + maximum;
+
+  if (doubledValue < doubledCenter)
+    state |= negative;
+  else if (doubledValue > doubledCenter)
+    state |= positive;
+
+  return static_cast<JOYSTICK_STATE_HAT>(state);
+}
@@ -18,6 +18,8 @@
  */
 #pragma once
 
+#include <kodi/addon-instance/Peripheral.h>
+
 namespace JOYSTICK
 {
   class CJoystick;
@@ -30,5 +32,18 @@ namespace JOYSTICK
      *        reports a joystick attached, even though none is present
      */
     static bool IsGhostJoystick(const CJoystick& joystick);
+
+    /*!
+     * \brief Update a hat's direction from one of its two axes
+     *
+     * \param hat The current direction of the hat
+     * \param bVertical True for the up/down axis, false for left/right
+     * \param value The axis value, below the center of the range for up or left
+     * \param minimum The minimum value of the axis
+     * \param maximum The maximum value of the axis
+     *
+     * \return The new direction of the hat
+     */
+    static JOYSTICK_STATE_HAT UpdateHatAxis(JOYSTICK_STATE_HAT hat, bool bVertical, int value, int minimum, int maximum);
   };
 }
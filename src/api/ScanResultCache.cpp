@@ -0,0 +1,115 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ScanResultCache.h"
+#include "Joystick.h"
+#include "log/Log.h"
+
+#include <algorithm>
+
+using namespace JOYSTICK;
+using namespace P8PLATFORM;
+
+CScanResultCache::ConvertedResults::~ConvertedResults(void)
+{
+  for (PERIPHERAL_INFO& info : structs)
+    kodi::addon::Peripheral::FreeStruct(info);
+}
+
+CScanResultCache::~CScanResultCache(void)
+{
+  CLockObject lock(m_mutex);
+
+  m_current.reset();
+  m_retired.clear();
+}
+
+void CScanResultCache::GetResults(unsigned int generation, const JoystickVector& joysticks,
+                                  unsigned int& count, PERIPHERAL_INFO*& results)
+{
+  count = 0;
+  results = nullptr;
+
+  if (joysticks.empty())
+    return;
+
+  CLockObject lock(m_mutex);
+
+  if (!m_current || m_current->generation != generation)
+  {
+    if (m_current && m_current->refCount > 0)
+      m_retired.push_back(std::move(m_current));
+
+    m_current.reset(new ConvertedResults);
+    m_current->generation = generation;
+    m_current->refCount = 0;
+    m_current->structs.resize(joysticks.size());
+
+    // Need to be explicit because we're using typedef struct { ... }T instead of struct T{ ... }
+    for (unsigned int i = 0; i < joysticks.size(); i++)
+      joysticks[i]->kodi::addon::Peripheral::ToStruct(m_current->structs[i]);
+  }
+
+  m_current->refCount++;
+
+  count = static_cast<unsigned int>(m_current->structs.size());
+  results = m_current->structs.data();
+}
+
+void CScanResultCache::FreeResults(unsigned int count, PERIPHERAL_INFO* results)
+{
+  if (results == nullptr)
+    return;
+
+  CLockObject lock(m_mutex);
+
+  if (m_current && m_current->Holds(count, results))
+  {
+    if (m_current->refCount > 0)
+      m_current->refCount--;
+    return;
+  }
+
+  auto it = std::find_if(m_retired.begin(), m_retired.end(),
+    [count, results](const ConvertedResultsPtr& retired)
+    {
+      return retired->Holds(count, results);
+    });
+
+  if (it == m_retired.end())
+  {
+    esyslog("%s: %u results at %p weren't handed out by this cache", __FUNCTION__, count, static_cast<void*>(results));
+    return;
+  }
+
+  if ((*it)->refCount > 0)
+    (*it)->refCount--;
+
+  ReleaseUnused();
+}
+
+void CScanResultCache::ReleaseUnused(void)
+{
+  m_retired.erase(std::remove_if(m_retired.begin(), m_retired.end(),
+    [](const ConvertedResultsPtr& retired)
+    {
+      return retired->refCount == 0;
+    }), m_retired.end());
+}
@@ -0,0 +1,86 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "JoystickTypes.h"
+
+#include <kodi/addon-instance/Peripheral.h>
+#include "p8-platform/threads/mutex.h"
+
+#include <memory>
+#include <vector>
+
+namespace JOYSTICK
+{
+  /*!
+   * \brief Keeps converted scan results for as long as the joystick set is
+   *        unchanged
+   *
+   * The frontend scans far more often than devices change. Results are
+   * converted to PERIPHERAL_INFO once per scan generation and handed out
+   * until the generation changes. Arrays are reference counted, so results
+   * from an older generation stay valid until the frontend frees them.
+   */
+  class CScanResultCache
+  {
+  public:
+    CScanResultCache(void) = default;
+    ~CScanResultCache(void);
+
+    /*!
+     * \brief Get the converted results for a scan
+     *
+     * \param generation The scan generation reported by the joystick manager
+     * \param joysticks The scan results, only converted if the generation changed
+     * \param[out] count The number of results
+     * \param[out] results The results, or nullptr if there are none
+     */
+    void GetResults(unsigned int generation, const JoystickVector& joysticks,
+                    unsigned int& count, PERIPHERAL_INFO*& results);
+
+    /*!
+     * \brief Release results returned by GetResults()
+     */
+    void FreeResults(unsigned int count, PERIPHERAL_INFO* results);
+
+  private:
+    struct ConvertedResults
+    {
+      ~ConvertedResults(void);
+
+      bool Holds(unsigned int count, const PERIPHERAL_INFO* results) const
+      {
+        return structs.data() == results && structs.size() == count;
+      }
+
+      unsigned int                 generation;
+      std::vector<PERIPHERAL_INFO> structs;
+      unsigned int                 refCount;
+    };
+
+    typedef std::unique_ptr<ConvertedResults> ConvertedResultsPtr;
+
+    void ReleaseUnused(void);
+
+    ConvertedResultsPtr              m_current;
+    std::vector<ConvertedResultsPtr> m_retired; // Still held by the frontend
+    P8PLATFORM::CMutex               m_mutex;
+  };
+}
@@ -0,0 +1,175 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ScanScheduler.h"
+#include "JoystickManager.h"
+#include "log/Log.h"
+#include "settings/Settings.h"
+
+#include "p8-platform/util/timeutils.h"
+
+
+using namespace JOYSTICK;
+using namespace P8PLATFORM;
+
+#define MIN_SCAN_INTERVAL_MS     1000 // Minimum time between two scans
+#define MAX_COALESCE_WINDOWS     8    // Scan anyway after this many windows of continuous requests
+
+CScanScheduler::CScanScheduler(void) :
+  m_scanner(nullptr),
+  m_pendingRequests(0),
+  m_requestCount(0),
+  m_scanCount(0),
+  m_lastScanMs(-1)
+{
+}
+
+bool CScanScheduler::Start(IScannerCallback* scanner)
+{
+  if (IsRunning())
+    return true;
+
+  {
+    CLockObject lock(m_mutex);
+
+    m_scanner = scanner;
+
+    // Requests made before there was a scanner were never going to be honored
+    m_pendingRequests = 0;
+  }
+
+  if (!CreateThread(false))
+  {
+    esyslog("Failed to start scan scheduler");
+    return false;
+  }
+
+  return true;
+}
+
+void CScanScheduler::Stop(void)
+{
+  StopThread(-1);
+  m_requestEvent.Signal();
+  StopThread();
+
+  CLockObject lock(m_mutex);
+
+  if (m_scanner != nullptr)
+  {
+    dsyslog("Scan scheduler: %u requests, %u scans, %u coalesced", m_requestCount, m_scanCount,
+            m_requestCount - m_scanCount - m_pendingRequests);
+  }
+
+  m_scanner = nullptr;
+  m_pendingRequests = 0;
+}
+
+void CScanScheduler::RequestScan(void)
+{
+  {
+    CLockObject lock(m_mutex);
+
+    m_pendingRequests++;
+    m_requestCount++;
+  }
+
+  m_requestEvent.Signal();
+}
+
+unsigned int CScanScheduler::CoalescedCount(void) const
+{
+  CLockObject lock(m_mutex);
+
+  return m_requestCount - m_scanCount - m_pendingRequests;
+}
+
+void* CScanScheduler::Process(void)
+{
+  while (!IsStopped())
+  {
+    m_requestEvent.Wait();
+
+    if (IsStopped())
+      break;
+
+    {
+      CLockObject lock(m_mutex);
+      if (m_pendingRequests == 0)
+        continue;
+    }
+
+    // Wait for the burst to settle
+    const unsigned int windowMs = CSettings::Get().ScanWindowMs();
+    if (windowMs > 0)
+    {
+      const int64_t maxDeadlineMs = GetTimeMs() + windowMs * MAX_COALESCE_WINDOWS;
+
+      while (!IsStopped() && GetTimeMs() < maxDeadlineMs)
+      {
+        if (!m_requestEvent.Wait(windowMs))
+          break; // Quiet for a whole window
+      }
+    }
+
+    // Keep scans apart
+    if (m_lastScanMs >= 0)
+      WaitUntil(m_lastScanMs + MIN_SCAN_INTERVAL_MS);
+
+    if (IsStopped())
+      break;
+
+    IScannerCallback* scanner;
+    unsigned int coalesced;
+
+    {
+      CLockObject lock(m_mutex);
+
+      scanner = m_scanner;
+      coalesced = m_pendingRequests - 1;
+
+      m_pendingRequests = 0;
+      m_scanCount++;
+    }
+
+    if (coalesced > 0)
+      dsyslog("Coalesced %u scan requests", coalesced);
+
+    m_lastScanMs = GetTimeMs();
+
+    if (scanner != nullptr)
+      scanner->TriggerScan();
+  }
+
+  return nullptr;
+}
+
+void CScanScheduler::WaitUntil(int64_t deadlineMs)
+{
+  while (!IsStopped())
+  {
+    const int64_t remainingMs = deadlineMs - GetTimeMs();
+    if (remainingMs <= 0)
+      break;
+
+    // Requests arriving now are folded into the upcoming scan
+    m_requestEvent.Wait(static_cast<uint32_t>(remainingMs));
+  }
+}
@@ -0,0 +1,86 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "p8-platform/threads/mutex.h"
+#include "p8-platform/threads/threads.h"
+
+#include <stdint.h>
+
+namespace JOYSTICK
+{
+  class IScannerCallback;
+
+  /*!
+   * \brief Coalesces requests for the frontend to rescan joysticks
+   *
+   * A burst of change notifications, such as a USB hub re-enumerating several
+   * pads, results in a single scan once no new request has arrived for the
+   * scan window. Scans are also kept a minimum interval apart.
+   */
+  class CScanScheduler : protected P8PLATFORM::CThread
+  {
+  public:
+    CScanScheduler(void);
+    virtual ~CScanScheduler(void) { Stop(); }
+
+    /*!
+     * \brief Start the scheduler thread
+     *
+     * \param scanner The callback used to trigger a scan
+     */
+    bool Start(IScannerCallback* scanner);
+
+    /*!
+     * \brief Stop the scheduler thread and wait for it to exit
+     *
+     * Pending requests are dropped.
+     */
+    void Stop(void);
+
+    /*!
+     * \brief Request a scan
+     */
+    void RequestScan(void);
+
+    /*!
+     * \brief Number of requests that were merged into another scan
+     */
+    unsigned int CoalescedCount(void) const;
+
+  protected:
+    // implementation of CThread
+    virtual void* Process(void) override;
+
+  private:
+    /*!
+     * \brief Absorb requests until the given time, or until stopped
+     */
+    void WaitUntil(int64_t deadlineMs);
+
+    IScannerCallback*          m_scanner;
+    P8PLATFORM::CEvent         m_requestEvent;
+    unsigned int               m_pendingRequests;
+    unsigned int               m_requestCount;
+    unsigned int               m_scanCount;
+    int64_t                    m_lastScanMs;
+    mutable P8PLATFORM::CMutex m_mutex;
+  };
+}
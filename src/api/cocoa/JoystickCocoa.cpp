@@ -143,12 +143,6 @@ void CJoystickCocoa::Deinitialize(void)
   m_bInitialized = false;
 }
 
-bool CJoystickCocoa::GetEvents(std::vector<kodi::addon::PeripheralEvent>& events)
-{
-  CLockObject lock(m_mutex);
-  return CJoystick::GetEvents(events);
-}
-
 bool CJoystickCocoa::ScanEvents(void)
 {
   CLockObject lock(m_mutex);
@@ -43,7 +43,6 @@ namespace JOYSTICK
     virtual bool Equals(const CJoystick* rhs) const override;
     virtual bool Initialize(void) override;
     virtual void Deinitialize(void) override;
-    virtual bool GetEvents(std::vector<kodi::addon::PeripheralEvent>& events) override;
 
     // implementation of ICocoaInputCallback
     virtual void InputValueChanged(IOHIDValueRef value) override;
@@ -23,93 +23,254 @@
 #include "api/JoystickTypes.h"
 #include "log/Log.h"
 
+#include <algorithm>
 #include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <linux/input.h>
 #include <linux/joystick.h>
+#include <poll.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/inotify.h>
 #include <sys/ioctl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 using namespace JOYSTICK;
 
+#define INPUT_DIRECTORY  "/dev/input"
+#define INVALID_FD       -1
+
+CJoystickInterfaceLinux::CJoystickInterfaceLinux(void) :
+  m_inotifyFd(INVALID_FD),
+  m_bRescan(true)
+{
+}
+
 EJoystickInterface CJoystickInterfaceLinux::Type(void) const
 {
   return EJoystickInterface::LINUX;
 }
 
+bool CJoystickInterfaceLinux::Initialize(void)
+{
+  m_bRescan = true;
+
+  // Watch for device nodes being added and removed. IN_ATTRIB is needed
+  // because udev fixes up permissions after the node is created.
+  m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (m_inotifyFd >= 0)
+  {
+    if (inotify_add_watch(m_inotifyFd, INPUT_DIRECTORY, IN_CREATE | IN_DELETE | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO) < 0)
+    {
+      dsyslog("%s: can't watch %s (errno=%d), falling back to directory scans", __FUNCTION__, INPUT_DIRECTORY, errno);
+      close(m_inotifyFd);
+      m_inotifyFd = INVALID_FD;
+    }
+  }
+  else
+  {
+    dsyslog("%s: inotify unavailable (errno=%d), falling back to directory scans", __FUNCTION__, errno);
+  }
+
+  return true;
+}
+
+void CJoystickInterfaceLinux::Deinitialize(void)
+{
+  if (m_inotifyFd >= 0)
+  {
+    close(m_inotifyFd);
+    m_inotifyFd = INVALID_FD;
+  }
+
+  m_joysticks.clear();
+  m_pendingNodes.clear();
+  m_bRescan = true;
+}
+
 bool CJoystickInterfaceLinux::ScanForJoysticks(JoystickVector& joysticks)
 {
-  // TODO: Use udev to grab device names instead of reading /dev/input/js*
-  std::string inputDir("/dev/input");
-  DIR *pd = opendir(inputDir.c_str());
-  if (pd == NULL)
+  // Without inotify the directory has to be enumerated on every scan
+  if (m_inotifyFd < 0 || !ReadDeviceChanges())
+    m_bRescan = true;
+
+  if (m_bRescan)
   {
-    // Disabled until udev is used to grab device names
-    //esyslog("%s: can't open %s (errno=%d)", __FUNCTION__, inputDir.c_str(), errno);
-    return false;
+    // TODO: Use udev to grab device names instead of reading /dev/input/js*
+    if (!ScanDirectory())
+      return false;
+
+    m_bRescan = (m_inotifyFd < 0);
   }
 
-  dirent *pDirent;
-  while ((pDirent = readdir(pd)) != NULL)
+  // Only probe nodes that haven't been opened yet
+  for (const std::string& nodeName : m_pendingNodes)
   {
-    if (std::string(pDirent->d_name).substr(0, 2) == "js")
-    {
-      // Found a joystick device
-      std::string filename(inputDir + "/" + pDirent->d_name);
+    if (m_joysticks.find(nodeName) != m_joysticks.end())
+      continue;
+
+    JoystickPtr joystick = OpenJoystick(nodeName);
+    if (joystick)
+      m_joysticks[nodeName] = joystick;
+  }
+  m_pendingNodes.clear();
+
+  for (const auto& joystick : m_joysticks)
+    joysticks.push_back(joystick.second);
+
+  return true;
+}
+
+bool CJoystickInterfaceLinux::NeedsScan(void)
+{
+  if (m_inotifyFd < 0 || m_bRescan || !m_pendingNodes.empty())
+    return true;
+
+  // Device nodes changed if inotify has events queued
+  struct pollfd pfd = { m_inotifyFd, POLLIN, 0 };
+  return poll(&pfd, 1, 0) != 0;
+}
 
-      int fd = open(filename.c_str(), O_RDONLY);
-      if (fd < 0)
+bool CJoystickInterfaceLinux::ReadDeviceChanges(void)
+{
+  // Large enough for several events with names
+  char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+
+  while (true)
+  {
+    ssize_t len = read(m_inotifyFd, buffer, sizeof(buffer));
+    if (len <= 0)
+    {
+      if (len < 0 && errno != EAGAIN)
       {
-        esyslog("%s: can't open %s (errno=%d)", __FUNCTION__, filename.c_str(), errno);
-        continue;
+        esyslog("%s: failed to read inotify events (errno=%d)", __FUNCTION__, errno);
+        return false;
       }
+      break;
+    }
 
-      unsigned char axes      = 0;
-      unsigned char buttons   = 0;
-      int           version   = 0x000000;
-      char          name[128] = { };
+    for (char* ptr = buffer; ptr < buffer + len; )
+    {
+      const inotify_event* event = reinterpret_cast<const inotify_event*>(ptr);
+      ptr += sizeof(inotify_event) + event->len;
 
-      if (ioctl(fd, JSIOCGVERSION, &version) < 0 ||
-          ioctl(fd, JSIOCGAXES, &axes)       < 0 ||
-          ioctl(fd, JSIOCGBUTTONS, &buttons) < 0 ||
-          ioctl(fd, JSIOCGNAME(128), name)   < 0)
-      {
-        esyslog("%s: failed ioctl() (errno=%d)", __FUNCTION__, errno);
-        close(fd);
+      if (event->mask & IN_Q_OVERFLOW)
+        return false;
+
+      if (event->len == 0)
         continue;
-      }
 
-      if (fcntl(fd, F_SETFL, O_NONBLOCK) < 0)
-      {
-        esyslog("%s: failed fcntl() (errno=%d)", __FUNCTION__, errno);
-        close(fd);
+      const std::string nodeName(event->name);
+      if (!IsJoystickNode(nodeName))
         continue;
-      }
 
-      // We don't support the old (0.x) interface
-      if (version < 0x010000)
+      if (event->mask & (IN_DELETE | IN_MOVED_FROM))
       {
-        esyslog("%s: old (0.x) interface is not supported (version=%08x)", __FUNCTION__, version);
-        close(fd);
-        continue;
+        m_joysticks.erase(nodeName);
+        m_pendingNodes.erase(nodeName);
+      }
+      else
+      {
+        m_pendingNodes.insert(nodeName);
       }
+    }
+  }
 
-      unsigned int index = (unsigned int)std::max(strtol(pDirent->d_name + strlen("js"), NULL, 10), 0L);
+  return true;
+}
 
-      JoystickPtr joystick = JoystickPtr(new CJoystickLinux(fd, filename));
-      joystick->SetName(name);
-      joystick->SetButtonCount(buttons);
-      joystick->SetAxisCount(axes);
-      joystick->SetRequestedPort(index);
-      joysticks.push_back(joystick);
-    }
+bool CJoystickInterfaceLinux::ScanDirectory(void)
+{
+  DIR *pd = opendir(INPUT_DIRECTORY);
+  if (pd == NULL)
+  {
+    // Disabled until udev is used to grab device names
+    //esyslog("%s: can't open %s (errno=%d)", __FUNCTION__, INPUT_DIRECTORY, errno);
+    return false;
+  }
+
+  std::set<std::string> nodeNames;
+
+  dirent *pDirent;
+  while ((pDirent = readdir(pd)) != NULL)
+  {
+    if (IsJoystickNode(pDirent->d_name))
+      nodeNames.insert(pDirent->d_name);
   }
 
   closedir(pd);
 
+  // Close joysticks whose nodes have disappeared
+  for (auto it = m_joysticks.begin(); it != m_joysticks.end(); )
+  {
+    if (nodeNames.find(it->first) == nodeNames.end())
+      it = m_joysticks.erase(it);
+    else
+      ++it;
+  }
+
+  m_pendingNodes.swap(nodeNames);
+
   return true;
 }
+
+JoystickPtr CJoystickInterfaceLinux::OpenJoystick(const std::string& nodeName)
+{
+  // Found a joystick device
+  std::string filename(INPUT_DIRECTORY "/" + nodeName);
+
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    esyslog("%s: can't open %s (errno=%d)", __FUNCTION__, filename.c_str(), errno);
+    return JoystickPtr();
+  }
+
+  unsigned char axes      = 0;
+  unsigned char buttons   = 0;
+  int           version   = 0x000000;
+  char          name[128] = { };
+
+  if (ioctl(fd, JSIOCGVERSION, &version) < 0 ||
+      ioctl(fd, JSIOCGAXES, &axes)       < 0 ||
+      ioctl(fd, JSIOCGBUTTONS, &buttons) < 0 ||
+      ioctl(fd, JSIOCGNAME(128), name)   < 0)
+  {
+    esyslog("%s: failed ioctl() (errno=%d)", __FUNCTION__, errno);
+    close(fd);
+    return JoystickPtr();
+  }
+
+  if (fcntl(fd, F_SETFL, O_NONBLOCK) < 0)
+  {
+    esyslog("%s: failed fcntl() (errno=%d)", __FUNCTION__, errno);
+    close(fd);
+    return JoystickPtr();
+  }
+
+  // We don't support the old (0.x) interface
+  if (version < 0x010000)
+  {
+    esyslog("%s: old (0.x) interface is not supported (version=%08x)", __FUNCTION__, version);
+    close(fd);
+    return JoystickPtr();
+  }
+
+  unsigned int index = (unsigned int)std::max(strtol(nodeName.c_str() + strlen("js"), NULL, 10), 0L);
+
+  JoystickPtr joystick = JoystickPtr(new CJoystickLinux(fd, filename));
+  joystick->SetName(name);
+  joystick->SetButtonCount(buttons);
+  joystick->SetAxisCount(axes);
+  joystick->SetRequestedPort(index);
+
+  return joystick;
+}
+
+bool CJoystickInterfaceLinux::IsJoystickNode(const std::string& nodeName)
+{
+  return nodeName.substr(0, 2) == "js";
+}
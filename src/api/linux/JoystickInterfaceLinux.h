@@ -21,6 +21,8 @@
 
 #include "api/IJoystickInterface.h"
 
+#include <map>
+#include <set>
 #include <stdint.h>
 #include <string>
 
@@ -29,11 +31,39 @@ namespace JOYSTICK
   class CJoystickInterfaceLinux : public IJoystickInterface
   {
   public:
-    CJoystickInterfaceLinux(void) { }
-    virtual ~CJoystickInterfaceLinux(void) { }
+    CJoystickInterfaceLinux(void);
+    virtual ~CJoystickInterfaceLinux(void) { Deinitialize(); }
 
     // implementation of IJoystickInterface
     virtual EJoystickInterface Type(void) const override;
+    virtual bool Initialize(void) override;
+    virtual void Deinitialize(void) override;
     virtual bool ScanForJoysticks(JoystickVector& joysticks) override;
+    virtual bool NeedsScan(void) override;
+
+  private:
+    /*!
+     * \brief Process device node changes reported by inotify
+     *
+     * \return False if changes were lost and the directory must be rescanned
+     */
+    bool ReadDeviceChanges(void);
+
+    /*!
+     * \brief Synchronize the opened joysticks with the device directory
+     */
+    bool ScanDirectory(void);
+
+    /*!
+     * \brief Open and probe a joystick device node
+     */
+    static JoystickPtr OpenJoystick(const std::string& nodeName);
+
+    static bool IsJoystickNode(const std::string& nodeName);
+
+    int                                m_inotifyFd;
+    bool                               m_bRescan; // Directory contents must be enumerated
+    std::map<std::string, JoystickPtr> m_joysticks; // Node name -> opened joystick
+    std::set<std::string>              m_pendingNodes; // Nodes that appeared since the last scan
   };
 }
@@ -20,6 +20,7 @@
 
 #include "JoystickLinux.h"
 #include "JoystickInterfaceLinux.h"
+#include "api/JoystickManager.h"
 #include "api/JoystickTypes.h"
 #include "log/Log.h"
 #include "utils/CommonMacros.h"
@@ -40,15 +41,55 @@ using namespace JOYSTICK;
 #define MAX_AXIS           32767
 #define INVALID_FD         -1
 
+// The joydev client queue holds 64 events (JOYDEV_BUFFER_SIZE), so a single
+// read of this size drains it
+#define EVENT_BATCH_SIZE   64
+
 CJoystickLinux::CJoystickLinux(int fd, const std::string& strFilename)
  : CJoystick(EJoystickInterface::LINUX),
    m_fd(fd),
-   m_strFilename(strFilename)
+   m_strFilename(strFilename),
+   m_bRecordingChecked(false),
+   m_startupEvents(0),
+   m_bResyncing(false),
+   m_readCount(0),
+   m_eventCount(0),
+   m_overflowCount(0),
+   m_ringToken(-1),
+   m_bRingChecked(false)
 {
 }
 
+bool CJoystickLinux::Initialize(void)
+{
+  if (!CJoystick::Initialize())
+    return false;
+
+  // Joydev reports the state of every button and axis when opened
+  m_startupEvents = ButtonCount() + AxisCount();
+  m_bResyncing = false;
+
+  return true;
+}
+
 void CJoystickLinux::Deinitialize(void)
 {
+  m_recorder.Close();
+
+#if defined(HAVE_IO_URING)
+  if (m_ringToken >= 0)
+  {
+    CJoystickManager::Get().InputRing().Unregister(m_ringToken);
+    m_ringToken = -1;
+  }
+#endif
+
+  if (m_readCount > 0)
+  {
+    dsyslog("%s: \"%s\" on %s: %u reads, %u events, %u queue overflows", __FUNCTION__,
+        Name().c_str(), m_strFilename.c_str(), m_readCount, m_eventCount, m_overflowCount);
+  }
+
   close(m_fd);
   m_fd = INVALID_FD;
 }
@@ -67,45 +108,154 @@ bool CJoystickLinux::Equals(const CJoystick* rhs) const
 
 bool CJoystickLinux::ScanEvents(void)
 {
-  js_event joyEvent;
+  js_event events[EVENT_BATCH_SIZE];
+
+  // Only joysticks that are polled get recorded, not every scan result
+  if (!m_bRecordingChecked)
+  {
+    m_bRecordingChecked = true;
+    if (CInputRecorder::IsEnabled())
+      OpenRecording();
+  }
+
+  const bool bRecording = m_recorder.IsOpen();
+
+#if defined(HAVE_IO_URING)
+  CInputRing& inputRing = CJoystickManager::Get().InputRing();
+
+  // Only joysticks that are polled post reads to the ring
+  if (!m_bRingChecked)
+  {
+    m_bRingChecked = true;
+    m_ringToken = inputRing.Register(m_fd, sizeof(events));
+  }
+
+  if (m_ringToken >= 0)
+  {
+    unsigned int readCount;
+    if (inputRing.TakeData(m_ringToken, m_ringData, readCount))
+    {
+      m_readCount += readCount;
+
+      const unsigned int eventCount = static_cast<unsigned int>(m_ringData.size() / sizeof(js_event));
+      m_eventCount += eventCount;
+
+      HandleEvents(reinterpret_cast<const js_event*>(m_ringData.data()), eventCount, bRecording);
+
+      if (bRecording)
+        m_recorder.Flush();
+
+      return true;
+    }
+
+    // Reads failed, fall back to read()
+    inputRing.Unregister(m_ringToken);
+    m_ringToken = -1;
+  }
+#endif
 
   while (true)
   {
     // Flush the driver queue
-    if (read(m_fd, &joyEvent, sizeof(joyEvent)) != sizeof(joyEvent))
+    ssize_t bytesRead = read(m_fd, events, sizeof(events));
+    m_readCount++;
+
+    if (bytesRead < static_cast<ssize_t>(sizeof(js_event)))
     {
-      if (errno == EAGAIN)
-      {
-        // The circular driver queue holds 64 events. If compiling your own driver,
-        // you can increment this size bumping up JS_BUFF_SIZE in joystick.h
-        break;
-      }
-      else
+      if (bytesRead < 0 && errno != EAGAIN)
       {
         esyslog("%s: failed to read joystick \"%s\" on %s - %d (%s)",
             __FUNCTION__, Name().c_str(), m_strFilename.c_str(), errno, strerror(errno));
-        break;
       }
+      break;
     }
 
-    // The possible values of joystickEvent.type are:
-    // JS_EVENT_BUTTON    0x01    // button pressed/released
-    // JS_EVENT_AXIS      0x02    // joystick moved
-    // JS_EVENT_INIT      0x80    // (flag) initial state of device
+    const unsigned int eventCount = static_cast<unsigned int>(bytesRead / sizeof(js_event));
+    m_eventCount += eventCount;
 
-    // Ignore initial events, because they mess up the buttons
-    switch (joyEvent.type)
-    {
-    case JS_EVENT_BUTTON:
-      SetButtonValue(joyEvent.number, (joyEvent.value ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED));
-      break;
-    case JS_EVENT_AXIS:
-      SetAxisValue(joyEvent.number, joyEvent.value, MAX_AXIS);
-      break;
-    default:
+    HandleEvents(events, eventCount, bRecording);
+
+    // A short read means the queue is empty, so skip the read that would
+    // only return EAGAIN
+    if (eventCount < EVENT_BATCH_SIZE)
       break;
-    }
   }
 
+  if (bRecording)
+    m_recorder.Flush();
+
   return true;
 }
+
+void CJoystickLinux::HandleEvents(const js_event* events, unsigned int eventCount, bool bRecording)
+{
+  for (unsigned int i = 0; i < eventCount; i++)
+  {
+    const js_event& joyEvent = events[i];
+
+    if (bRecording)
+      m_recorder.Record(static_cast<int64_t>(joyEvent.time) * 1000, joyEvent.type, joyEvent.number, joyEvent.value);
+
+    ProcessEvent(joyEvent);
+  }
+}
+
+void CJoystickLinux::ProcessEvent(const js_event& joyEvent)
+{
+  // The possible values of joystickEvent.type are:
+  // JS_EVENT_BUTTON    0x01    // button pressed/released
+  // JS_EVENT_AXIS      0x02    // joystick moved
+  // JS_EVENT_INIT      0x80    // (flag) initial state of device
+
+  if (joyEvent.type & JS_EVENT_INIT)
+  {
+    // Ignore initial events after opening, because they mess up the buttons
+    if (m_startupEvents > 0)
+    {
+      m_startupEvents--;
+      return;
+    }
+
+    // When the client queue overflows, joydev discards it and reports the
+    // full device state again as initial events. Apply them to resync.
+    if (!m_bResyncing)
+    {
+      m_bResyncing = true;
+      m_overflowCount++;
+      dsyslog("%s: event queue overflowed on \"%s\", resynchronizing", __FUNCTION__, Name().c_str());
+    }
+  }
+  else
+  {
+    m_startupEvents = 0;
+    m_bResyncing = false;
+  }
+
+  switch (joyEvent.type & ~JS_EVENT_INIT)
+  {
+  case JS_EVENT_BUTTON:
+    SetButtonValue(joyEvent.number, (joyEvent.value ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED));
+    break;
+  case JS_EVENT_AXIS:
+    SetAxisValue(joyEvent.number, joyEvent.value, MAX_AXIS);
+    break;
+  default:
+    break;
+  }
+}
+
+void CJoystickLinux::OpenRecording()
+{
+  InputRecordingHeader header;
+
+  header.format      = EInputRecordingFormat::JOYDEV;
+  header.name        = Name();
+  header.provider    = Provider();
+  header.vendorId    = VendorID();
+  header.productId   = ProductID();
+  header.buttonCount = ButtonCount();
+  header.hatCount    = HatCount();
+  header.axisCount   = AxisCount();
+
+  m_recorder.Open(header);
+}
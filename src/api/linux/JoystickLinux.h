@@ -20,9 +20,12 @@
 #pragma once
 
 #include "api/Joystick.h"
+#include "api/replay/InputRecorder.h"
 
+#include <linux/joystick.h>
 #include <stdint.h>
 #include <string>
+#include <vector>
 
 namespace JOYSTICK
 {
@@ -33,14 +36,36 @@ namespace JOYSTICK
     virtual ~CJoystickLinux(void) { Deinitialize(); }
 
     // implementation of CJoystick
+    virtual bool Initialize(void) override;
     virtual void Deinitialize(void) override;
     virtual bool Equals(const CJoystick* rhs) const override;
+    virtual int GetInputFd(void) const override { return m_fd; }
 
   protected:
     virtual bool ScanEvents(void) override;
 
   private:
-    int         m_fd;
-    std::string m_strFilename;
+    void HandleEvents(const js_event* events, unsigned int eventCount, bool bRecording);
+    void ProcessEvent(const js_event& joyEvent);
+    void OpenRecording();
+
+    int            m_fd;
+    std::string    m_strFilename;
+    CInputRecorder m_recorder;
+    bool           m_bRecordingChecked;
+
+    // Queue overflow detection
+    unsigned int   m_startupEvents; // Initial state events still expected after opening
+    bool           m_bResyncing;
+
+    // Statistics
+    unsigned int   m_readCount;
+    unsigned int   m_eventCount;
+    unsigned int   m_overflowCount;
+
+    // Reads through the manager's io_uring, if available
+    int                  m_ringToken;
+    bool                 m_bRingChecked;
+    std::vector<uint8_t> m_ringData;
   };
 }
@@ -0,0 +1,274 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "StateMirror.h"
+#include "StateMirrorFormat.h"
+#include "api/Joystick.h"
+#include "api/JoystickStateStore.h"
+#include "log/Log.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace JOYSTICK;
+using namespace P8PLATFORM;
+
+#define SHM_ENVIRONMENT_VARIABLE       "KODI_JOYSTICK_SHM"
+#define SHM_MODE_ENVIRONMENT_VARIABLE  "KODI_JOYSTICK_SHM_MODE" // Octal, e.g. "644" to let other users read
+#define SHM_DEFAULT_MODE               (S_IRUSR | S_IWUSR)
+#define SHM_ALLOWED_MODE               (S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) // Only the owner may write
+
+#ifndef INVALID_FD
+  #define INVALID_FD  (-1)
+#endif
+
+namespace
+{
+  uint32_t Align(uint32_t offset, uint32_t alignment)
+  {
+    return (offset + alignment - 1) / alignment * alignment;
+  }
+
+  mode_t GetSegmentMode(void)
+  {
+    const char* strMode = getenv(SHM_MODE_ENVIRONMENT_VARIABLE);
+    if (strMode == nullptr || *strMode == '\0')
+      return SHM_DEFAULT_MODE;
+
+    char* end = nullptr;
+    const long mode = strtol(strMode, &end, 8);
+    if (*end != '\0' || mode < 0 || (mode & ~static_cast<long>(SHM_ALLOWED_MODE)) != 0)
+    {
+      esyslog("Ignoring %s=%s, only read access can be granted to others", SHM_MODE_ENVIRONMENT_VARIABLE, strMode);
+      return SHM_DEFAULT_MODE;
+    }
+
+    return static_cast<mode_t>(mode) | S_IRUSR | S_IWUSR;
+  }
+}
+
+CStateMirror::CStateMirror(void) :
+  m_fd(INVALID_FD),
+  m_segment(nullptr)
+{
+}
+
+bool CStateMirror::IsEnabled(void)
+{
+  const char* name = getenv(SHM_ENVIRONMENT_VARIABLE);
+  return name != nullptr && *name != '\0';
+}
+
+bool CStateMirror::Open(void)
+{
+  Close();
+
+  const char* name = getenv(SHM_ENVIRONMENT_VARIABLE);
+  if (name == nullptr || *name == '\0')
+    return false;
+
+  CLockObject lock(m_mutex);
+
+  // POSIX requires a leading slash for portable names
+  m_name = name;
+  if (m_name[0] != '/')
+    m_name.insert(0, "/");
+
+  // Never reuse an existing segment, it may belong to someone else
+  const mode_t mode = GetSegmentMode();
+  m_fd = shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, mode);
+  if (m_fd < 0)
+  {
+    if (errno == EEXIST)
+      esyslog("Shared memory \"%s\" already exists, remove it or choose another name", m_name.c_str());
+    else
+      esyslog("Failed to create shared memory \"%s\": %s", m_name.c_str(), strerror(errno));
+    return false;
+  }
+
+  // The umask applies to shm_open(), set the requested mode explicitly
+  struct stat info;
+  if (fstat(m_fd, &info) < 0 || info.st_uid != geteuid() || fchmod(m_fd, mode) < 0)
+  {
+    esyslog("Failed to secure shared memory \"%s\"", m_name.c_str());
+    close(m_fd);
+    m_fd = INVALID_FD;
+    shm_unlink(m_name.c_str());
+    return false;
+  }
+
+  if (ftruncate(m_fd, STATE_MIRROR_SIZE) < 0)
+  {
+    esyslog("Failed to size shared memory \"%s\": %s", m_name.c_str(), strerror(errno));
+    close(m_fd);
+    m_fd = INVALID_FD;
+    shm_unlink(m_name.c_str());
+    return false;
+  }
+
+  void* segment = mmap(nullptr, STATE_MIRROR_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+  if (segment == MAP_FAILED)
+  {
+    esyslog("Failed to map shared memory \"%s\": %s", m_name.c_str(), strerror(errno));
+    close(m_fd);
+    m_fd = INVALID_FD;
+    shm_unlink(m_name.c_str());
+    return false;
+  }
+
+  m_segment = static_cast<uint8_t*>(segment);
+
+  // Readers see an empty, consistent segment until the first layout
+  memset(m_segment, 0, STATE_MIRROR_SIZE);
+
+  StateMirrorHeader* header = Header();
+  header->magic = STATE_MIRROR_MAGIC;
+  header->version = STATE_MIRROR_VERSION;
+  header->size = STATE_MIRROR_SIZE;
+  header->sequence.store(0, std::memory_order_release);
+
+  isyslog("Publishing joystick state to shared memory \"%s\"", m_name.c_str());
+
+  return true;
+}
+
+void CStateMirror::Close(void)
+{
+  CLockObject lock(m_mutex);
+
+  m_devices.clear();
+
+  if (m_segment != nullptr)
+  {
+    munmap(m_segment, STATE_MIRROR_SIZE);
+    m_segment = nullptr;
+  }
+
+  if (m_fd >= 0)
+  {
+    close(m_fd);
+    m_fd = INVALID_FD;
+    shm_unlink(m_name.c_str());
+  }
+}
+
+void CStateMirror::SetLayout(const JoystickVector& joysticks, const CJoystickStateStore& stateStore)
+{
+  CLockObject lock(m_mutex);
+
+  if (m_segment == nullptr)
+    return;
+
+  StateMirrorHeader* header = Header();
+
+  const uint32_t sequence = header->sequence.load(std::memory_order_relaxed);
+  header->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  m_devices.clear();
+
+  StateMirrorDevice* records = reinterpret_cast<StateMirrorDevice*>(m_segment + sizeof(StateMirrorHeader));
+
+  // State follows the record table
+  uint32_t offset = sizeof(StateMirrorHeader) + joysticks.size() * sizeof(StateMirrorDevice);
+
+  for (const JoystickPtr& joystick : joysticks)
+  {
+    const uint32_t buttonOffset = Align(offset, sizeof(uint32_t));
+    const uint32_t buttonBytes = (joystick->ButtonCount() + 31) / 32 * sizeof(uint32_t);
+    const uint32_t hatOffset = buttonOffset + buttonBytes;
+    const uint32_t axisOffset = Align(hatOffset + joystick->HatCount(), sizeof(float));
+    const uint32_t end = axisOffset + joystick->AxisCount() * sizeof(float);
+
+    if (end > STATE_MIRROR_SIZE)
+    {
+      esyslog("Shared memory \"%s\" is full, not publishing joystick %u", m_name.c_str(), joystick->Index());
+      continue;
+    }
+
+    StateMirrorDevice& record = records[m_devices.size()];
+    memset(&record, 0, sizeof(record));
+
+    record.index = joystick->Index();
+    record.buttonCount = joystick->ButtonCount();
+    record.hatCount = joystick->HatCount();
+    record.axisCount = joystick->AxisCount();
+    record.buttonOffset = buttonOffset;
+    record.hatOffset = hatOffset;
+    record.axisOffset = axisOffset;
+    strncpy(record.provider, joystick->Provider().c_str(), STATE_MIRROR_PROVIDER_LENGTH - 1);
+    strncpy(record.name, joystick->Name().c_str(), STATE_MIRROR_NAME_LENGTH - 1);
+
+    memset(m_segment + buttonOffset, 0, end - buttonOffset);
+
+    m_devices.push_back({ joystick->StateSlot(), &record });
+
+    offset = end;
+  }
+
+  header->deviceCount = m_devices.size();
+
+  PublishLocked(stateStore);
+
+  header->updateCount++;
+  header->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void CStateMirror::Publish(const CJoystickStateStore& stateStore)
+{
+  CLockObject lock(m_mutex);
+
+  if (m_segment == nullptr || m_devices.empty())
+    return;
+
+  StateMirrorHeader* header = Header();
+
+  const uint32_t sequence = header->sequence.load(std::memory_order_relaxed);
+  header->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  PublishLocked(stateStore);
+
+  header->updateCount++;
+  header->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void CStateMirror::PublishLocked(const CJoystickStateStore& stateStore)
+{
+  for (const MirroredDevice& device : m_devices)
+  {
+    const StateMirrorDevice& record = *device.record;
+
+    stateStore.ReadState(device.slot,
+                         reinterpret_cast<uint32_t*>(m_segment + record.buttonOffset),
+                         m_segment + record.hatOffset,
+                         reinterpret_cast<float*>(m_segment + record.axisOffset));
+  }
+}
+
+StateMirrorHeader* CStateMirror::Header(void) const
+{
+  return reinterpret_cast<StateMirrorHeader*>(m_segment);
+}
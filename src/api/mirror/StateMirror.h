@@ -0,0 +1,101 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "api/JoystickTypes.h"
+
+#include "p8-platform/threads/mutex.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace JOYSTICK
+{
+  class CJoystickStateStore;
+  struct StateMirrorDevice;
+  struct StateMirrorHeader;
+
+  /*!
+   * \brief Publishes the state of all joysticks to POSIX shared memory
+   *
+   * Local consumers map the segment read-only and copy input without a
+   * syscall. The layout is described in StateMirrorFormat.h.
+   *
+   * Publishing is enabled by setting the environment variable
+   * KODI_JOYSTICK_SHM to the name of the segment, e.g. "/kodi-joystick".
+   * The segment must not exist yet and is removed when the mirror is closed.
+   * It is only accessible by the owner unless KODI_JOYSTICK_SHM_MODE grants
+   * read access to others, e.g. "644".
+   */
+  class CStateMirror
+  {
+  public:
+    CStateMirror(void);
+    ~CStateMirror(void) { Close(); }
+
+    /*!
+     * \brief Check if publishing has been requested
+     */
+    static bool IsEnabled(void);
+
+    /*!
+     * \brief Create and map the shared-memory segment
+     *
+     * \return False if the segment couldn't be created, including when a
+     *         segment with the same name already exists
+     */
+    bool Open(void);
+
+    /*!
+     * \brief Unmap and remove the segment
+     */
+    void Close(void);
+
+    /*!
+     * \brief Describe the joysticks in the segment and publish their state
+     *
+     * Joysticks that don't fit in the segment are left out.
+     */
+    void SetLayout(const JoystickVector& joysticks, const CJoystickStateStore& stateStore);
+
+    /*!
+     * \brief Copy the state of the described joysticks into the segment
+     */
+    void Publish(const CJoystickStateStore& stateStore);
+
+  private:
+    struct MirroredDevice
+    {
+      int                slot;   // Slot in the state store
+      StateMirrorDevice* record;
+    };
+
+    void PublishLocked(const CJoystickStateStore& stateStore);
+
+    StateMirrorHeader* Header(void) const;
+
+    std::string                 m_name;
+    int                         m_fd;
+    uint8_t*                    m_segment;
+    std::vector<MirroredDevice> m_devices;
+    P8PLATFORM::CMutex          m_mutex;
+  };
+}
@@ -0,0 +1,74 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+/*!
+ * Layout of the shared-memory segment published by CStateMirror
+ *
+ * The segment starts with a StateMirrorHeader, followed by deviceCount
+ * StateMirrorDevice records. Offsets in the records are in bytes from the
+ * start of the segment. The segment size never changes while it exists.
+ *
+ * Readers use the sequence number as a seqlock:
+ *
+ *   1. Read the sequence. If it is odd, an update is in progress; retry.
+ *   2. Copy the records and the state they describe.
+ *   3. Read the sequence again. If it changed, discard the copy and retry.
+ */
+#define STATE_MIRROR_MAGIC            0x4D534A4B // "KJSM"
+#define STATE_MIRROR_VERSION          1
+#define STATE_MIRROR_SIZE             (64 * 1024)
+#define STATE_MIRROR_PROVIDER_LENGTH  16
+#define STATE_MIRROR_NAME_LENGTH      64
+
+namespace JOYSTICK
+{
+  struct StateMirrorHeader
+  {
+    uint32_t              magic;
+    uint32_t              version;
+    uint32_t              size;        // Size of the segment in bytes
+    std::atomic<uint32_t> sequence;    // Odd while the segment is being written
+    uint32_t              deviceCount;
+    uint32_t              reserved;
+    uint64_t              updateCount; // Incremented on every publication
+  };
+
+  struct StateMirrorDevice
+  {
+    uint32_t index;        // Joystick index, as reported in peripheral events
+    uint16_t buttonCount;
+    uint16_t hatCount;
+    uint16_t axisCount;
+    uint16_t reserved;
+    uint32_t buttonOffset; // uint32_t words, button i is bit i % 32 of word i / 32
+    uint32_t hatOffset;    // One byte per hat, a JOYSTICK_STATE_HAT
+    uint32_t axisOffset;   // One float per axis, in the interval [-1.0, 1.0]
+    char     provider[STATE_MIRROR_PROVIDER_LENGTH]; // Null-terminated
+    char     name[STATE_MIRROR_NAME_LENGTH];         // Null-terminated
+  };
+
+  static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "Sequence must be a plain 32-bit word");
+  static_assert(sizeof(uint32_t) == sizeof(unsigned int) && ATOMIC_INT_LOCK_FREE == 2,
+                "Sequence must be lock-free to be shared with other processes");
+}
@@ -0,0 +1,130 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "InputRecorder.h"
+#include "log/Log.h"
+#include "utils/StringUtils.h"
+
+#include <algorithm>
+#include <errno.h>
+#include <limits>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+using namespace JOYSTICK;
+
+#define CAPTURE_ENVIRONMENT_VARIABLE  "KODI_JOYSTICK_CAPTURE"
+#define CAPTURE_EXTENSION             ".jsrec"
+
+CInputRecorder::CInputRecorder(void) :
+  m_file(nullptr),
+  m_previousTimestampUs(-1),
+  m_eventCount(0)
+{
+}
+
+bool CInputRecorder::IsEnabled(void)
+{
+  const char* directory = getenv(CAPTURE_ENVIRONMENT_VARIABLE);
+  return directory != nullptr && *directory != '\0';
+}
+
+bool CInputRecorder::Open(const InputRecordingHeader& header)
+{
+  Close();
+
+  const char* directory = getenv(CAPTURE_ENVIRONMENT_VARIABLE);
+  if (directory == nullptr || *directory == '\0')
+    return false;
+
+  // Several devices of the same model may be opened in the same second, so
+  // append a counter to keep the filenames unique
+  static unsigned int captureIndex = 0;
+
+  m_path = StringUtils::Format("%s/%s_%s_%lu_%u%s", directory,
+      header.provider.c_str(), StringUtils::MakeSafeUrl(header.name).c_str(),
+      static_cast<unsigned long>(time(nullptr)), captureIndex++, CAPTURE_EXTENSION);
+
+  m_file = fopen(m_path.c_str(), "wb");
+  if (m_file == nullptr)
+  {
+    esyslog("Failed to create recording \"%s\": %s", m_path.c_str(), strerror(errno));
+    return false;
+  }
+
+  if (!CInputRecording::WriteHeader(m_file, header))
+  {
+    esyslog("Failed to write recording \"%s\"", m_path.c_str());
+    fclose(m_file);
+    m_file = nullptr;
+    return false;
+  }
+
+  m_previousTimestampUs = -1;
+  m_eventCount = 0;
+
+  isyslog("Recording \"%s\" to %s", header.name.c_str(), m_path.c_str());
+
+  return true;
+}
+
+void CInputRecorder::Record(int64_t timestampUs, uint16_t type, uint16_t code, int32_t value)
+{
+  if (m_file == nullptr)
+    return;
+
+  int64_t deltaUs = 0;
+  if (m_previousTimestampUs >= 0 && timestampUs > m_previousTimestampUs)
+    deltaUs = timestampUs - m_previousTimestampUs;
+  m_previousTimestampUs = timestampUs;
+
+  InputRecordingEvent event;
+  event.deltaUs = static_cast<uint32_t>(std::min<int64_t>(deltaUs, std::numeric_limits<uint32_t>::max()));
+  event.type    = type;
+  event.code    = code;
+  event.value   = value;
+
+  if (!CInputRecording::WriteEvent(m_file, event))
+  {
+    esyslog("Failed to write to recording \"%s\", stopping capture", m_path.c_str());
+    Close();
+    return;
+  }
+
+  m_eventCount++;
+}
+
+void CInputRecorder::Flush(void)
+{
+  if (m_file != nullptr)
+    fflush(m_file);
+}
+
+void CInputRecorder::Close(void)
+{
+  if (m_file != nullptr)
+  {
+    fclose(m_file);
+    m_file = nullptr;
+
+    isyslog("Finished recording %s (%u events)", m_path.c_str(), m_eventCount);
+  }
+}
@@ -0,0 +1,85 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "InputRecording.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+
+namespace JOYSTICK
+{
+  /*!
+   * \brief Records the raw event stream of a joystick to disk
+   *
+   * Capturing is enabled by setting the environment variable
+   * KODI_JOYSTICK_CAPTURE to an existing directory. One recording is created
+   * per opened device.
+   */
+  class CInputRecorder
+  {
+  public:
+    CInputRecorder(void);
+    ~CInputRecorder(void) { Close(); }
+
+    /*!
+     * \brief Check if capturing has been requested
+     */
+    static bool IsEnabled(void);
+
+    /*!
+     * \brief Create a new recording in the capture directory
+     *
+     * \param header The properties of the joystick being recorded
+     *
+     * \return True if the recording was created
+     */
+    bool Open(const InputRecordingHeader& header);
+
+    /*!
+     * \brief Check if a recording is in progress
+     */
+    bool IsOpen(void) const { return m_file != nullptr; }
+
+    /*!
+     * \brief Append a raw event to the recording
+     *
+     * \param timestampUs The driver timestamp of the event, in microseconds
+     */
+    void Record(int64_t timestampUs, uint16_t type, uint16_t code, int32_t value);
+
+    /*!
+     * \brief Flush recorded events to disk
+     */
+    void Flush(void);
+
+    /*!
+     * \brief Finish the recording
+     */
+    void Close(void);
+
+  private:
+    FILE*        m_file;
+    std::string  m_path;
+    int64_t      m_previousTimestampUs;
+    unsigned int m_eventCount;
+  };
+}
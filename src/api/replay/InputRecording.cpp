@@ -0,0 +1,226 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "InputRecording.h"
+#include "log/Log.h"
+
+#include <algorithm>
+#include <errno.h>
+#include <string.h>
+
+using namespace JOYSTICK;
+
+#define RECORDING_MAGIC        "KJOYREC"
+#define RECORDING_MAGIC_SIZE   8 // Including null terminator
+#define RECORDING_VERSION      3 // Version 2 adds flat and fuzz to axes, version 3 stores the range of hat axes
+#define MIN_RECORDING_VERSION  1
+#define MAX_STRING_LENGTH      1024
+
+namespace
+{
+  template<typename T>
+  bool WriteValue(FILE* file, T value)
+  {
+    return fwrite(&value, sizeof(value), 1, file) == 1;
+  }
+
+  template<typename T>
+  bool ReadValue(FILE* file, T& value)
+  {
+    return fread(&value, sizeof(value), 1, file) == 1;
+  }
+
+  bool WriteString(FILE* file, const std::string& str)
+  {
+    const uint16_t length = static_cast<uint16_t>(std::min(str.size(), static_cast<size_t>(MAX_STRING_LENGTH)));
+
+    return WriteValue(file, length) &&
+           fwrite(str.c_str(), 1, length, file) == length;
+  }
+
+  bool ReadString(FILE* file, std::string& str)
+  {
+    uint16_t length;
+    if (!ReadValue(file, length) || length > MAX_STRING_LENGTH)
+      return false;
+
+    str.resize(length);
+    return length == 0 || fread(&str[0], 1, length, file) == length;
+  }
+}
+
+bool CInputRecording::Load(const std::string& path)
+{
+  FILE* file = fopen(path.c_str(), "rb");
+  if (file == nullptr)
+  {
+    esyslog("Failed to open recording \"%s\": %s", path.c_str(), strerror(errno));
+    return false;
+  }
+
+  m_events.clear();
+
+  bool bSuccess = ReadHeader(file, m_header);
+  if (bSuccess)
+  {
+    InputRecordingEvent event;
+    while (ReadEvent(file, event))
+      m_events.push_back(event);
+
+    dsyslog("Loaded recording \"%s\" of \"%s\" (%s) with %u events", path.c_str(),
+        m_header.name.c_str(), m_header.provider.c_str(), static_cast<unsigned int>(m_events.size()));
+  }
+  else
+  {
+    esyslog("Invalid recording: \"%s\"", path.c_str());
+  }
+
+  fclose(file);
+
+  return bSuccess;
+}
+
+bool CInputRecording::WriteHeader(FILE* file, const InputRecordingHeader& header)
+{
+  char magic[RECORDING_MAGIC_SIZE] = RECORDING_MAGIC;
+
+  if (fwrite(magic, sizeof(magic), 1, file) != 1)
+    return false;
+
+  if (!WriteValue<uint16_t>(file, RECORDING_VERSION) ||
+      !WriteValue<uint16_t>(file, static_cast<uint16_t>(header.format)) ||
+      !WriteString(file, header.name) ||
+      !WriteString(file, header.provider) ||
+      !WriteValue(file, header.vendorId) ||
+      !WriteValue(file, header.productId) ||
+      !WriteValue(file, header.buttonCount) ||
+      !WriteValue(file, header.hatCount) ||
+      !WriteValue(file, header.axisCount))
+    return false;
+
+  if (!WriteValue(file, static_cast<uint32_t>(header.buttons.size())))
+    return false;
+
+  for (const InputRecordingButton& button : header.buttons)
+  {
+    if (!WriteValue(file, button.code) ||
+        !WriteValue(file, button.buttonIndex))
+      return false;
+  }
+
+  if (!WriteValue(file, static_cast<uint32_t>(header.axes.size())))
+    return false;
+
+  for (const InputRecordingAxis& axis : header.axes)
+  {
+    if (!WriteValue(file, axis.code) ||
+        !WriteValue(file, axis.axisIndex) ||
+        !WriteValue(file, axis.minimum) ||
+        !WriteValue(file, axis.maximum) ||
+        !WriteValue(file, axis.flat) ||
+        !WriteValue(file, axis.fuzz))
+      return false;
+  }
+
+  return true;
+}
+
+bool CInputRecording::WriteEvent(FILE* file, const InputRecordingEvent& event)
+{
+  return WriteValue(file, event.deltaUs) &&
+         WriteValue(file, event.type) &&
+         WriteValue(file, event.code) &&
+         WriteValue(file, event.value);
+}
+
+bool CInputRecording::ReadHeader(FILE* file, InputRecordingHeader& header)
+{
+  char magic[RECORDING_MAGIC_SIZE] = { };
+
+  if (fread(magic, sizeof(magic), 1, file) != 1 ||
+      strncmp(magic, RECORDING_MAGIC, sizeof(magic)) != 0)
+    return false;
+
+  uint16_t version;
+  uint16_t format;
+
+  if (!ReadValue(file, version) || version < MIN_RECORDING_VERSION || version > RECORDING_VERSION)
+    return false;
+
+  if (!ReadValue(file, format) || format > static_cast<uint16_t>(EInputRecordingFormat::JOYDEV))
+    return false;
+
+  header.format = static_cast<EInputRecordingFormat>(format);
+
+  if (!ReadString(file, header.name) ||
+      !ReadString(file, header.provider) ||
+      !ReadValue(file, header.vendorId) ||
+      !ReadValue(file, header.productId) ||
+      !ReadValue(file, header.buttonCount) ||
+      !ReadValue(file, header.hatCount) ||
+      !ReadValue(file, header.axisCount))
+    return false;
+
+  uint32_t count;
+
+  if (!ReadValue(file, count))
+    return false;
+
+  header.buttons.clear();
+  for (uint32_t i = 0; i < count; i++)
+  {
+    InputRecordingButton button;
+    if (!ReadValue(file, button.code) ||
+        !ReadValue(file, button.buttonIndex))
+      return false;
+    header.buttons.push_back(button);
+  }
+
+  if (!ReadValue(file, count))
+    return false;
+
+  header.axes.clear();
+  for (uint32_t i = 0; i < count; i++)
+  {
+    InputRecordingAxis axis = { };
+    if (!ReadValue(file, axis.code) ||
+        !ReadValue(file, axis.axisIndex) ||
+        !ReadValue(file, axis.minimum) ||
+        !ReadValue(file, axis.maximum))
+      return false;
+    if (version >= 2)
+    {
+      if (!ReadValue(file, axis.flat) ||
+          !ReadValue(file, axis.fuzz))
+        return false;
+    }
+    header.axes.push_back(axis);
+  }
+
+  return true;
+}
+
+bool CInputRecording::ReadEvent(FILE* file, InputRecordingEvent& event)
+{
+  return ReadValue(file, event.deltaUs) &&
+         ReadValue(file, event.type) &&
+         ReadValue(file, event.code) &&
+         ReadValue(file, event.value);
+}
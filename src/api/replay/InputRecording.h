@@ -0,0 +1,140 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace JOYSTICK
+{
+  /*!
+   * \brief Format of the raw events contained in a recording
+   */
+  enum class EInputRecordingFormat
+  {
+    EVDEV,  // input_event from the evdev interface (udev)
+    JOYDEV, // js_event from the joystick interface (linux)
+  };
+
+  /*!
+   * \brief A single raw driver event
+   *
+   * Events are stored as the time elapsed since the previous event. The
+   * first event of a recording has a delta of 0, so playback starts with it.
+   */
+  struct InputRecordingEvent
+  {
+    uint32_t deltaUs;
+    uint16_t type;
+    uint16_t code;
+    int32_t  value;
+  };
+
+  /*!
+   * \brief Maps an evdev key code to a button index
+   */
+  struct InputRecordingButton
+  {
+    uint16_t code;
+    uint16_t buttonIndex;
+  };
+
+  /*!
+   * \brief Maps an evdev absolute axis code to an axis index and its range
+   *
+   * If the header has hats, ABS_HAT0X to ABS_HAT3Y map to a hat index instead.
+   *
+   * Flat and fuzz are calibrated like live input. Version 1 recordings don't
+   * store them, so they are replayed without a flat zone or noise filter.
+   */
+  struct InputRecordingAxis
+  {
+    uint16_t code;
+    uint16_t axisIndex;
+    int32_t  minimum;
+    int32_t  maximum;
+    int32_t  flat;
+    int32_t  fuzz;
+  };
+
+  /*!
+   * \brief Properties of the recorded joystick
+   *
+   * The bindings are only used for evdev recordings. Joydev events already
+   * contain button and axis indices.
+   */
+  struct InputRecordingHeader
+  {
+    EInputRecordingFormat             format = EInputRecordingFormat::EVDEV;
+    std::string                       name;
+    std::string                       provider;
+    uint16_t                          vendorId = 0;
+    uint16_t                          productId = 0;
+    uint32_t                          buttonCount = 0;
+    uint32_t                          hatCount = 0;
+    uint32_t                          axisCount = 0;
+    std::vector<InputRecordingButton> buttons;
+    std::vector<InputRecordingAxis>   axes;
+  };
+
+  /*!
+   * \brief A recording of the raw event stream of a single joystick
+   *
+   * Recordings are a compact binary file: a header describing the joystick,
+   * followed by fixed-size event records until the end of the file. Values
+   * are stored in host byte order.
+   */
+  class CInputRecording
+  {
+  public:
+    CInputRecording(void) = default;
+
+    /*!
+     * \brief Load a recording from disk
+     *
+     * \param path The path of the recording
+     *
+     * \return True if the header was read, even if no events follow
+     */
+    bool Load(const std::string& path);
+
+    const InputRecordingHeader& Header(void) const { return m_header; }
+    const std::vector<InputRecordingEvent>& Events(void) const { return m_events; }
+
+    /*!
+     * \brief Serialize a recording header to an open file
+     */
+    static bool WriteHeader(FILE* file, const InputRecordingHeader& header);
+
+    /*!
+     * \brief Serialize an event record to an open file
+     */
+    static bool WriteEvent(FILE* file, const InputRecordingEvent& event);
+
+  private:
+    static bool ReadHeader(FILE* file, InputRecordingHeader& header);
+    static bool ReadEvent(FILE* file, InputRecordingEvent& event);
+
+    InputRecordingHeader             m_header;
+    std::vector<InputRecordingEvent> m_events;
+  };
+}
@@ -0,0 +1,118 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "JoystickInterfaceReplay.h"
+#include "JoystickReplay.h"
+#include "api/JoystickTypes.h"
+#include "filesystem/DirectoryUtils.h"
+#include "log/Log.h"
+
+#include <kodi/Filesystem.h>
+
+#include <algorithm>
+#include <stdlib.h>
+
+using namespace JOYSTICK;
+
+#define REPLAY_ENVIRONMENT_VARIABLE  "KODI_JOYSTICK_REPLAY"
+#define SPEED_ENVIRONMENT_VARIABLE   "KODI_JOYSTICK_REPLAY_SPEED"
+#define LOOP_ENVIRONMENT_VARIABLE    "KODI_JOYSTICK_REPLAY_LOOP"
+#define RECORDING_EXTENSION          ".jsrec"
+#define DEFAULT_SPEED                1.0f
+
+bool CJoystickInterfaceReplay::IsEnabled(void)
+{
+  const char* path = getenv(REPLAY_ENVIRONMENT_VARIABLE);
+  return path != nullptr && *path != '\0';
+}
+
+EJoystickInterface CJoystickInterfaceReplay::Type(void) const
+{
+  return EJoystickInterface::REPLAY;
+}
+
+bool CJoystickInterfaceReplay::Initialize(void)
+{
+  const char* path = getenv(REPLAY_ENVIRONMENT_VARIABLE);
+  if (path == nullptr || *path == '\0')
+    return false;
+
+  float speed = DEFAULT_SPEED;
+
+  const char* strSpeed = getenv(SPEED_ENVIRONMENT_VARIABLE);
+  if (strSpeed != nullptr)
+  {
+    speed = static_cast<float>(atof(strSpeed));
+    if (speed <= 0.0f)
+    {
+      esyslog("Invalid replay speed \"%s\", using %.1f", strSpeed, DEFAULT_SPEED);
+      speed = DEFAULT_SPEED;
+    }
+  }
+
+  const char* strLoop = getenv(LOOP_ENVIRONMENT_VARIABLE);
+  const bool bLoop = (strLoop != nullptr && atoi(strLoop) != 0);
+
+  std::vector<kodi::vfs::CDirEntry> items;
+  if (CDirectoryUtils::Exists(path) && CDirectoryUtils::GetDirectory(path, RECORDING_EXTENSION, items))
+  {
+    // Sort for a stable joystick order between runs
+    std::sort(items.begin(), items.end(),
+      [](const kodi::vfs::CDirEntry& lhs, const kodi::vfs::CDirEntry& rhs)
+      {
+        return lhs.Path() < rhs.Path();
+      });
+
+    for (const kodi::vfs::CDirEntry& item : items)
+    {
+      if (!item.IsFolder())
+        AddRecording(item.Path(), speed, bLoop);
+    }
+  }
+  else
+  {
+    AddRecording(path, speed, bLoop);
+  }
+
+  isyslog("Replaying %u recordings from %s at %.2fx speed", static_cast<unsigned int>(m_joysticks.size()), path, speed);
+
+  return !m_joysticks.empty();
+}
+
+void CJoystickInterfaceReplay::Deinitialize(void)
+{
+  m_joysticks.clear();
+}
+
+bool CJoystickInterfaceReplay::ScanForJoysticks(JoystickVector& joysticks)
+{
+  joysticks.insert(joysticks.end(), m_joysticks.begin(), m_joysticks.end());
+  return true;
+}
+
+void CJoystickInterfaceReplay::AddRecording(const std::string& path, float speed, bool bLoop)
+{
+  std::shared_ptr<CJoystickReplay> joystick = std::make_shared<CJoystickReplay>(path, speed, bLoop);
+  if (joystick->LoadRecording())
+  {
+    joystick->SetRequestedPort(static_cast<int>(m_joysticks.size()));
+    m_joysticks.push_back(joystick);
+  }
+}
@@ -0,0 +1,57 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "api/IJoystickInterface.h"
+
+namespace JOYSTICK
+{
+  /*!
+   * \brief Interface that provides joysticks from recorded event streams
+   *
+   * The interface is enabled by setting the environment variable
+   * KODI_JOYSTICK_REPLAY to a recording or to a directory of recordings.
+   * KODI_JOYSTICK_REPLAY_SPEED sets the playback speed (default 1.0) and
+   * KODI_JOYSTICK_REPLAY_LOOP=1 restarts recordings when they finish.
+   */
+  class CJoystickInterfaceReplay : public IJoystickInterface
+  {
+  public:
+    CJoystickInterfaceReplay(void) = default;
+    virtual ~CJoystickInterfaceReplay(void) { Deinitialize(); }
+
+    /*!
+     * \brief Check if recordings have been requested for playback
+     */
+    static bool IsEnabled(void);
+
+    // implementation of IJoystickInterface
+    virtual EJoystickInterface Type(void) const override;
+    virtual bool Initialize(void) override;
+    virtual void Deinitialize(void) override;
+    virtual bool ScanForJoysticks(JoystickVector& joysticks) override;
+    virtual bool NeedsScan(void) override { return false; } // Recordings are fixed at startup
+
+  private:
+    void AddRecording(const std::string& path, float speed, bool bLoop);
+
+    JoystickVector m_joysticks;
+  };
+}
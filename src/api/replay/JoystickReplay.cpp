@@ -0,0 +1,250 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "JoystickReplay.h"
+#include "api/JoystickTranslator.h"
+#include "api/JoystickTypes.h"
+#include "api/JoystickUtils.h"
+#include "log/Log.h"
+
+#include "p8-platform/util/timeutils.h"
+
+using namespace JOYSTICK;
+
+// Event types and codes from linux/input.h and linux/joystick.h. They are
+// duplicated here so that recordings can be replayed on any platform.
+#define EVDEV_EV_KEY          0x01
+#define EVDEV_EV_ABS          0x03
+#define EVDEV_ABS_HAT0X       0x10
+#define EVDEV_ABS_HAT3Y       0x17
+#define JOYDEV_EVENT_BUTTON   0x01
+#define JOYDEV_EVENT_AXIS     0x02
+#define JOYDEV_EVENT_INIT     0x80
+#define JOYDEV_MAX_AXIS       32767
+
+CJoystickReplay::CJoystickReplay(const std::string& path, float speed, bool bLoop)
+ : CJoystick(EJoystickInterface::REPLAY),
+   m_path(path),
+   m_speedPermille(static_cast<int64_t>(speed * 1000.0f + 0.5f)),
+   m_bLoop(bLoop),
+   m_startTimeMs(-1),
+   m_nextEventUs(0),
+   m_eventIndex(0),
+   m_startupEvents(0)
+{
+}
+
+bool CJoystickReplay::LoadRecording(void)
+{
+  if (!m_recording.Load(m_path))
+    return false;
+
+  const InputRecordingHeader& header = m_recording.Header();
+
+  // Report the recorded provider so that the device's button map is used
+  if (JoystickTranslator::GetInterfaceType(header.provider) == EJoystickInterface::NONE)
+  {
+    esyslog("Recording \"%s\" has unknown provider \"%s\"", m_path.c_str(), header.provider.c_str());
+    return false;
+  }
+
+  SetName(header.name);
+  SetProvider(header.provider);
+  SetVendorID(header.vendorId);
+  SetProductID(header.productId);
+  SetButtonCount(header.buttonCount);
+  SetHatCount(header.hatCount);
+  SetAxisCount(header.axisCount);
+
+  m_buttons.clear();
+  for (const InputRecordingButton& button : header.buttons)
+    m_buttons[button.code] = button.buttonIndex;
+
+  m_axes.clear();
+  m_hats.clear();
+  for (const InputRecordingAxis& axis : header.axes)
+  {
+    // Older recordings have no hats and report hat axes as axes
+    if (header.hatCount > 0 && EVDEV_ABS_HAT0X <= axis.code && axis.code <= EVDEV_ABS_HAT3Y)
+    {
+      m_hats[axis.code] = axis;
+    }
+    else if (axis.maximum > axis.minimum)
+    {
+      ReplayAxis& replayAxis = m_axes[axis.code];
+      replayAxis.axisIndex = axis.axisIndex;
+      replayAxis.calibration.Calibrate(axis.minimum, axis.maximum, axis.flat, axis.fuzz,
+                                       CAxisCalibration::IsEvdevTrigger(axis.code, axis.minimum));
+    }
+  }
+
+  return true;
+}
+
+bool CJoystickReplay::Equals(const CJoystick* rhs) const
+{
+  const CJoystickReplay* rhsReplay = dynamic_cast<const CJoystickReplay*>(rhs);
+  if (rhsReplay == nullptr)
+    return false;
+
+  return m_path == rhsReplay->m_path;
+}
+
+bool CJoystickReplay::Initialize(void)
+{
+  if (!CJoystick::Initialize())
+    return false;
+
+  Rewind();
+
+  return true;
+}
+
+bool CJoystickReplay::ScanEvents(void)
+{
+  const std::vector<InputRecordingEvent>& events = m_recording.Events();
+
+  if (events.empty())
+    return true;
+
+  const int64_t nowMs = P8PLATFORM::GetTimeMs();
+
+  // Start the clock on the first poll so that startup time isn't skipped
+  if (m_startTimeMs < 0)
+    m_startTimeMs = nowMs;
+
+  // Milliseconds times thousandths of the speed is microseconds
+  const uint64_t elapsedUs = static_cast<uint64_t>((nowMs - m_startTimeMs) * m_speedPermille);
+
+  while (m_eventIndex < events.size() && m_nextEventUs <= elapsedUs)
+  {
+    ProcessEvent(events[m_eventIndex++]);
+
+    if (m_eventIndex < events.size())
+      m_nextEventUs += events[m_eventIndex].deltaUs;
+  }
+
+  if (m_eventIndex >= events.size() && m_bLoop)
+    Rewind();
+
+  return true;
+}
+
+void CJoystickReplay::Rewind(void)
+{
+  const std::vector<InputRecordingEvent>& events = m_recording.Events();
+
+  m_startTimeMs = -1;
+  m_eventIndex = 0;
+  m_nextEventUs = events.empty() ? 0 : events[0].deltaUs;
+  m_startupEvents = ButtonCount() + AxisCount();
+  m_hatStates.assign(HatCount(), JOYSTICK_STATE_HAT_UNPRESSED);
+}
+
+void CJoystickReplay::ProcessEvent(const InputRecordingEvent& event)
+{
+  switch (m_recording.Header().format)
+  {
+  case EInputRecordingFormat::EVDEV:
+    ProcessEvdevEvent(event);
+    break;
+  case EInputRecordingFormat::JOYDEV:
+    ProcessJoydevEvent(event);
+    break;
+  default:
+    break;
+  }
+}
+
+void CJoystickReplay::ProcessEvdevEvent(const InputRecordingEvent& event)
+{
+  switch (event.type)
+  {
+    case EVDEV_EV_KEY:
+    {
+      auto it = m_buttons.find(event.code);
+      if (it != m_buttons.end())
+        SetButtonValue(it->second, event.value ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED);
+      break;
+    }
+    case EVDEV_EV_ABS:
+    {
+      auto itHat = m_hats.find(event.code);
+      if (itHat != m_hats.end())
+      {
+        const unsigned int hatIndex = itHat->second.axisIndex;
+        const bool bVertical = ((event.code - EVDEV_ABS_HAT0X) % 2) != 0;
+
+        if (hatIndex < m_hatStates.size())
+        {
+          const JOYSTICK_STATE_HAT newState = CJoystickUtils::UpdateHatAxis(m_hatStates[hatIndex], bVertical, event.value,
+                                                                        itHat->second.minimum, itHat->second.maximum);
+          if (newState != m_hatStates[hatIndex])
+          {
+            m_hatStates[hatIndex] = newState;
+            SetHatValue(hatIndex, newState);
+          }
+        }
+        break;
+      }
+
+      auto it = m_axes.find(event.code);
+      if (it != m_axes.end())
+      {
+        float value;
+        if (it->second.calibration.Apply(event.value, value))
+          SetAxisValue(it->second.axisIndex, value);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+void CJoystickReplay::ProcessJoydevEvent(const InputRecordingEvent& event)
+{
+  // Ignore initial events after opening, but apply the ones that resync
+  // state after a queue overflow, as the live joystick does
+  if (event.type & JOYDEV_EVENT_INIT)
+  {
+    if (m_startupEvents > 0)
+    {
+      m_startupEvents--;
+      return;
+    }
+  }
+  else
+  {
+    m_startupEvents = 0;
+  }
+
+  switch (event.type & ~JOYDEV_EVENT_INIT)
+  {
+  case JOYDEV_EVENT_BUTTON:
+    SetButtonValue(event.code, event.value ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED);
+    break;
+  case JOYDEV_EVENT_AXIS:
+    SetAxisValue(event.code, event.value, JOYDEV_MAX_AXIS);
+    break;
+  default:
+    break;
+  }
+}
@@ -0,0 +1,95 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "InputRecording.h"
+#include "api/AxisCalibration.h"
+#include "api/Joystick.h"
+
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace JOYSTICK
+{
+  /*!
+   * \brief Joystick that plays back a recorded raw event stream
+   *
+   * Raw events are decoded the same way as the live device would decode them,
+   * so the replayed joystick exercises the regular event path. The joystick
+   * reports the name and provider of the recorded device so that its button
+   * map is used.
+   */
+  class CJoystickReplay : public CJoystick
+  {
+  public:
+    /*!
+     * \param path The path of the recording
+     * \param speed Playback speed, 1.0 for real time
+     * \param bLoop True to restart the recording when it finishes
+     */
+    CJoystickReplay(const std::string& path, float speed, bool bLoop);
+    virtual ~CJoystickReplay(void) { Deinitialize(); }
+
+    /*!
+     * \brief Load the recording and fill out joystick properties
+     */
+    bool LoadRecording(void);
+
+    // implementation of CJoystick
+    virtual bool Equals(const CJoystick* rhs) const override;
+    virtual bool Initialize(void) override;
+
+  protected:
+    // implementation of CJoystick
+    virtual bool ScanEvents(void) override;
+
+  private:
+    void Rewind(void);
+    void ProcessEvent(const InputRecordingEvent& event);
+    void ProcessEvdevEvent(const InputRecordingEvent& event);
+    void ProcessJoydevEvent(const InputRecordingEvent& event);
+
+    struct ReplayAxis
+    {
+      unsigned int     axisIndex;
+      CAxisCalibration calibration; // Evdev recordings are calibrated like live input
+    };
+
+    // Construction parameters
+    const std::string m_path;
+    const int64_t     m_speedPermille; // Playback speed in thousandths, to keep timing in integers
+    const bool        m_bLoop;
+
+    // Recording properties
+    CInputRecording                                m_recording;
+    std::map<uint16_t, unsigned int>               m_buttons; // Maps keycodes -> button
+    std::map<uint16_t, ReplayAxis>                 m_axes; // Maps keycodes -> axis and calibration
+    std::map<uint16_t, InputRecordingAxis>         m_hats; // Maps keycodes -> hat
+    std::vector<JOYSTICK_STATE_HAT>                m_hatStates;
+
+    // Playback state
+    int64_t      m_startTimeMs;
+    uint64_t     m_nextEventUs; // Time of the next event since the start of playback
+    unsigned int m_eventIndex;
+    unsigned int m_startupEvents; // Joydev initial state events still expected
+  };
+}
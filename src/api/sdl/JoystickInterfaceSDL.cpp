@@ -21,12 +21,16 @@
 
 #include "JoystickInterfaceSDL.h"
 #include "JoystickSDL.h"
+#include "api/JoystickManager.h"
 #include "api/JoystickTypes.h"
+#include "log/Log.h"
 
 #include <SDL2/SDL.h>
 
 using namespace JOYSTICK;
 
+#define EVENT_BATCH_SIZE  64
+
 EJoystickInterface CJoystickInterfaceSDL::Type(void) const
 {
   return EJoystickInterface::SDL;
@@ -34,23 +38,148 @@ EJoystickInterface CJoystickInterfaceSDL::Type(void) const
 
 bool CJoystickInterfaceSDL::Initialize(void)
 {
-  return (SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER | SDL_INIT_HAPTIC) == 0);
+  if (SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER | SDL_INIT_HAPTIC) != 0)
+    return false;
+
+  // Input is read from controller events. Don't queue the duplicate joystick
+  // events, only the device events that announce hotplugs.
+  SDL_EventState(SDL_JOYAXISMOTION, SDL_IGNORE);
+  SDL_EventState(SDL_JOYBALLMOTION, SDL_IGNORE);
+  SDL_EventState(SDL_JOYHATMOTION, SDL_IGNORE);
+  SDL_EventState(SDL_JOYBUTTONDOWN, SDL_IGNORE);
+  SDL_EventState(SDL_JOYBUTTONUP, SDL_IGNORE);
+
+  // Open the controllers that are already connected. SDL also queues added
+  // events for them, which are ignored for open controllers.
+  for (int i = 0; i < SDL_NumJoysticks(); i++)
+  {
+    if (SDL_IsGameController(i))
+      OpenController(i);
+  }
+
+  return true;
 }
 
 void CJoystickInterfaceSDL::Deinitialize(void)
 {
+  m_joysticks.clear();
+
   SDL_QuitSubSystem(SDL_INIT_GAMECONTROLLER | SDL_INIT_HAPTIC);
 }
 
 bool CJoystickInterfaceSDL::ScanForJoysticks(JoystickVector& joysticks)
 {
-  for (int i = 0; i < SDL_NumJoysticks(); i++)
+  // Controllers are tracked from device events, so no enumeration is needed
+  for (const auto& joystick : m_joysticks)
+    joysticks.push_back(joystick.second);
+
+  return true;
+}
+
+void CJoystickInterfaceSDL::PollEvents(void)
+{
+  bool bChanged = false;
+
+  SDL_PumpEvents();
+
+  SDL_Event events[EVENT_BATCH_SIZE];
+
+  int eventCount;
+  while ((eventCount = SDL_PeepEvents(events, EVENT_BATCH_SIZE, SDL_GETEVENT,
+                                      SDL_JOYAXISMOTION, SDL_CONTROLLERDEVICEREMAPPED)) > 0)
   {
-    if (!SDL_IsGameController(i))
-      continue;
+    for (int i = 0; i < eventCount; i++)
+    {
+      const SDL_Event& event = events[i];
 
-    joysticks.push_back(JoystickPtr(new CJoystickSDL(i)));
+      switch (event.type)
+      {
+        case SDL_CONTROLLERAXISMOTION:
+        {
+          auto it = m_joysticks.find(event.caxis.which);
+          if (it != m_joysticks.end())
+            it->second->OnAxisMotion(event.caxis.axis, event.caxis.value);
+          break;
+        }
+        case SDL_CONTROLLERBUTTONDOWN:
+        case SDL_CONTROLLERBUTTONUP:
+        {
+          auto it = m_joysticks.find(event.cbutton.which);
+          if (it != m_joysticks.end())
+            it->second->OnButton(event.cbutton.button, event.cbutton.state == SDL_PRESSED);
+          break;
+        }
+        case SDL_CONTROLLERDEVICEADDED:
+        {
+          // For added events, "which" is the device index
+          if (OpenController(event.cdevice.which))
+            bChanged = true;
+          break;
+        }
+        case SDL_CONTROLLERDEVICEREMOVED:
+        {
+          // For removed events, "which" is the instance ID
+          if (CloseController(event.cdevice.which))
+            bChanged = true;
+          break;
+        }
+        case SDL_JOYDEVICEADDED:
+        {
+          // Game controllers are opened from their controller event. Other
+          // joysticks aren't reported, but the frontend should still rescan.
+          if (!SDL_IsGameController(event.jdevice.which))
+          {
+            dsyslog("SDL joystick %d is not a game controller", event.jdevice.which);
+            bChanged = true;
+          }
+          break;
+        }
+        case SDL_JOYDEVICEREMOVED:
+        {
+          bChanged = true;
+          break;
+        }
+        default:
+          break;
+      }
+    }
   }
 
+  // Nothing else reads SDL's queue in the add-on, so drop the event types
+  // that aren't handled above before they fill it up
+  SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+  if (bChanged)
+  {
+    CJoystickManager::Get().SetChanged(true);
+    CJoystickManager::Get().TriggerScan();
+  }
+}
+
+bool CJoystickInterfaceSDL::OpenController(int deviceIndex)
+{
+  SDL_GameController* controller = SDL_GameControllerOpen(deviceIndex);
+  if (controller == nullptr)
+  {
+    esyslog("Failed to open SDL game controller %d: %s", deviceIndex, SDL_GetError());
+    return false;
+  }
+
+  const int32_t instanceId = SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(controller));
+
+  if (m_joysticks.find(instanceId) != m_joysticks.end())
+  {
+    // Already open, release the extra reference
+    SDL_GameControllerClose(controller);
+    return false;
+  }
+
+  m_joysticks[instanceId] = std::make_shared<CJoystickSDL>(controller, instanceId);
+
   return true;
 }
+
+bool CJoystickInterfaceSDL::CloseController(int32_t instanceId)
+{
+  return m_joysticks.erase(instanceId) > 0;
+}
@@ -22,8 +22,14 @@
 
 #include "api/IJoystickInterface.h"
 
+#include <map>
+#include <memory>
+#include <stdint.h>
+
 namespace JOYSTICK
 {
+  class CJoystickSDL;
+
   class CJoystickInterfaceSDL : public IJoystickInterface
   {
   public:
@@ -35,5 +41,13 @@ namespace JOYSTICK
     virtual bool Initialize(void) override;
     virtual void Deinitialize(void) override;
     virtual bool ScanForJoysticks(JoystickVector& joysticks) override;
+    virtual bool NeedsScan(void) override { return false; } // Changes are announced with SetChanged()
+    virtual void PollEvents(void) override;
+
+  private:
+    bool OpenController(int deviceIndex);
+    bool CloseController(int32_t instanceId);
+
+    std::map<int32_t, std::shared_ptr<CJoystickSDL>> m_joysticks; // Instance ID -> joystick
   };
 }
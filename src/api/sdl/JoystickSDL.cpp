@@ -22,6 +22,7 @@
 #include "JoystickSDL.h"
 #include "api/JoystickTypes.h"
 #include "log/Log.h"
+#include "utils/CommonMacros.h"
 
 #include <SDL2/SDL.h>
 
@@ -29,16 +30,58 @@ using namespace JOYSTICK;
 
 #define MAX_AXIS      32768
 
-CJoystickSDL::CJoystickSDL(unsigned int index) :
+namespace
+{
+  // Button indices reported to the frontend, in the order they were
+  // historically polled
+  const SDL_GameControllerButton Buttons[] =
+  {
+    SDL_CONTROLLER_BUTTON_A,
+    SDL_CONTROLLER_BUTTON_B,
+    SDL_CONTROLLER_BUTTON_X,
+    SDL_CONTROLLER_BUTTON_Y,
+    SDL_CONTROLLER_BUTTON_LEFTSHOULDER,
+    SDL_CONTROLLER_BUTTON_RIGHTSHOULDER,
+    SDL_CONTROLLER_BUTTON_BACK,
+    SDL_CONTROLLER_BUTTON_START,
+    SDL_CONTROLLER_BUTTON_LEFTSTICK,
+    SDL_CONTROLLER_BUTTON_RIGHTSTICK,
+    SDL_CONTROLLER_BUTTON_DPAD_UP,
+    SDL_CONTROLLER_BUTTON_DPAD_RIGHT,
+    SDL_CONTROLLER_BUTTON_DPAD_DOWN,
+    SDL_CONTROLLER_BUTTON_DPAD_LEFT,
+    SDL_CONTROLLER_BUTTON_GUIDE,
+  };
+
+  int GetButtonIndex(uint8_t button)
+  {
+    for (unsigned int i = 0; i < ARRAY_SIZE(Buttons); i++)
+    {
+      if (Buttons[i] == button)
+        return static_cast<int>(i);
+    }
+    return -1;
+  }
+}
+
+CJoystickSDL::CJoystickSDL(SDL_GameController* controller, int32_t instanceId) :
   CJoystick(EJoystickInterface::SDL),
-  m_index(index),
-  m_pController(nullptr)
+  m_instanceId(instanceId),
+  m_pController(controller)
 {
   SetName("SDL Game Controller");
   SetButtonCount(SDL_CONTROLLER_BUTTON_MAX);
   SetAxisCount(SDL_CONTROLLER_AXIS_MAX);
 }
 
+CJoystickSDL::~CJoystickSDL(void)
+{
+  Deinitialize();
+
+  if (m_pController != nullptr)
+    SDL_GameControllerClose(m_pController);
+}
+
 bool CJoystickSDL::Equals(const CJoystick* rhs) const
 {
   if (rhs == nullptr)
@@ -48,68 +91,49 @@ bool CJoystickSDL::Equals(const CJoystick* rhs) const
   if (rhsSDL == nullptr)
     return false;
 
-  return m_index == rhsSDL->m_index;
+  return m_instanceId == rhsSDL->m_instanceId;
 }
 
 bool CJoystickSDL::Initialize(void)
 {
-  bool bSuccess = false;
+  if (m_pController == nullptr || !CJoystick::Initialize())
+    return false;
 
-  if (CJoystick::Initialize())
-  {
-    if (m_pController == nullptr)
-      m_pController = SDL_GameControllerOpen(m_index);
+  const char* controllerName = SDL_GameControllerName(m_pController);
+  isyslog("%s %d initialized: \"%s\"", Name().c_str(), m_instanceId,
+      controllerName ? controllerName : "");
 
-    if (m_pController != nullptr)
-    {
-      const char* controllerName = SDL_GameControllerNameForIndex(m_index);
-      isyslog("%s %d initialized: \"%s\"", Name().c_str(), m_index,
-          controllerName ? controllerName : "");
-      bSuccess = true;
-    }
-  }
+  // Input arrives as events from now on, so start from the current state
+  ReadState();
 
-  return bSuccess;
+  return true;
 }
 
-void CJoystickSDL::Deinitialize(void)
+void CJoystickSDL::OnButton(uint8_t button, bool bPressed)
 {
-  if (m_pController != nullptr)
-  {
-    SDL_GameControllerClose(m_pController);
-    m_pController = nullptr;
-  }
+  const int buttonIndex = GetButtonIndex(button);
+  if (buttonIndex >= 0)
+    SetButtonValue(buttonIndex, bPressed ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED);
+}
 
-  CJoystick::Deinitialize();
+void CJoystickSDL::OnAxisMotion(uint8_t axis, int16_t value)
+{
+  // Axis indices match SDL_GameControllerAxis
+  if (axis < SDL_CONTROLLER_AXIS_MAX)
+    SetAxisValue(axis, static_cast<long>(value), MAX_AXIS);
 }
 
 bool CJoystickSDL::ScanEvents(void)
 {
-  if (m_pController == nullptr)
-    return false;
+  // Input is dispatched from the interface's event queue
+  return m_pController != nullptr;
+}
 
-  SetButtonValue(0,  SDL_GameControllerGetButton(m_pController, SDL_CONTROLLER_BUTTON_A)             ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED);
-  SetButtonValue(1,  SDL_GameControllerGetButton(m_pController, SDL_CONTROLLER_BUTTON_B)             ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED);
-  SetButtonValue(2,  SDL_GameControllerGetButton(m_pController, SDL_CONTROLLER_BUTTON_X)             ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED);
-  SetButtonValue(3,  SDL_GameControllerGetButton(m_pController, SDL_CONTROLLER_BUTTON_Y)             ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED);
-  SetButtonValue(4,  SDL_GameControllerGetButton(m_pController, SDL_CONTROLLER_BUTTON_LEFTSHOULDER)  ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED);
-  SetButtonValue(5,  SDL_GameControllerGetButton(m_pController, SDL_CONTROLLER_BUTTON_RIGHTSHOULDER) ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED);
-  SetButtonValue(6,  SDL_GameControllerGetButton(m_pController, SDL_CONTROLLER_BUTTON_BACK)          ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED);
-  SetButtonValue(7,  SDL_GameControllerGetButton(m_pController, SDL_CONTROLLER_BUTTON_START)         ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED);
-  SetButtonValue(8,  SDL_GameControllerGetButton(m_pController, SDL_CONTROLLER_BUTTON_LEFTSTICK)     ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED);
-  SetButtonValue(9,  SDL_GameControllerGetButton(m_pController, SDL_CONTROLLER_BUTTON_RIGHTSTICK)    ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED);
-  SetButtonValue(10, SDL_GameControllerGetButton(m_pController, SDL_CONTROLLER_BUTTON_DPAD_UP)       ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED);
-  SetButtonValue(11, SDL_GameControllerGetButton(m_pController, SDL_CONTROLLER_BUTTON_DPAD_RIGHT)    ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED);
-  SetButtonValue(12, SDL_GameControllerGetButton(m_pController, SDL_CONTROLLER_BUTTON_DPAD_DOWN)     ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED);
-  SetButtonValue(13, SDL_GameControllerGetButton(m_pController, SDL_CONTROLLER_BUTTON_DPAD_LEFT)     ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED);
-  SetButtonValue(14, SDL_GameControllerGetButton(m_pController, SDL_CONTROLLER_BUTTON_GUIDE)         ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED);
-
-  SetAxisValue(0, (long)SDL_GameControllerGetAxis(m_pController, SDL_CONTROLLER_AXIS_LEFTX), MAX_AXIS);
-  SetAxisValue(1, (long)SDL_GameControllerGetAxis(m_pController, SDL_CONTROLLER_AXIS_LEFTY), MAX_AXIS);
-  SetAxisValue(2, (long)SDL_GameControllerGetAxis(m_pController, SDL_CONTROLLER_AXIS_RIGHTX), MAX_AXIS);
-  SetAxisValue(3, (long)SDL_GameControllerGetAxis(m_pController, SDL_CONTROLLER_AXIS_RIGHTY), MAX_AXIS);
-  SetAxisValue(4, (long)SDL_GameControllerGetAxis(m_pController, SDL_CONTROLLER_AXIS_TRIGGERLEFT), MAX_AXIS);
-  SetAxisValue(5, (long)SDL_GameControllerGetAxis(m_pController, SDL_CONTROLLER_AXIS_TRIGGERRIGHT), MAX_AXIS);
+void CJoystickSDL::ReadState(void)
+{
+  for (unsigned int i = 0; i < ARRAY_SIZE(Buttons); i++)
+    OnButton(Buttons[i], SDL_GameControllerGetButton(m_pController, Buttons[i]) != 0);
 
-  return true;
+  for (int axis = 0; axis < SDL_CONTROLLER_AXIS_MAX; axis++)
+    OnAxisMotion(axis, SDL_GameControllerGetAxis(m_pController, static_cast<SDL_GameControllerAxis>(axis)));
 }
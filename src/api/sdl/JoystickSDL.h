@@ -22,6 +22,8 @@
 
 #include "api/Joystick.h"
 
+#include <stdint.h>
+
 typedef struct _SDL_GameController SDL_GameController;
 
 namespace JOYSTICK
@@ -29,20 +31,37 @@ namespace JOYSTICK
   class CJoystickSDL : public CJoystick
   {
   public:
-    CJoystickSDL(unsigned int index);
-    virtual ~CJoystickSDL(void) { Deinitialize(); }
+    /*!
+     * \brief Create a joystick for an opened controller
+     *
+     * \param controller The controller, closed when the joystick is destroyed
+     * \param instanceId The controller's joystick instance ID
+     */
+    CJoystickSDL(SDL_GameController* controller, int32_t instanceId);
+    virtual ~CJoystickSDL(void);
 
     // implementation of CJoystick
     virtual bool Equals(const CJoystick* rhs) const override;
     virtual bool Initialize(void) override;
-    virtual void Deinitialize(void) override;
+
+    /*!
+     * \brief Handle a button event from the SDL event queue
+     */
+    void OnButton(uint8_t button, bool bPressed);
+
+    /*!
+     * \brief Handle an axis event from the SDL event queue
+     */
+    void OnAxisMotion(uint8_t axis, int16_t value);
 
   protected:
     virtual bool ScanEvents(void) override;
 
   private:
+    void ReadState(void);
+
     // Construction parameters
-    const unsigned int m_index;
+    const int32_t m_instanceId;
 
     // SDL parameters
     SDL_GameController *m_pController;
@@ -0,0 +1,395 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "EventTap.h"
+#include "log/Log.h"
+
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace JOYSTICK;
+using namespace P8PLATFORM;
+
+#define TAP_ENVIRONMENT_VARIABLE  "KODI_JOYSTICK_TAP"
+
+#define MAX_QUEUED_RECORDS    8192 // Dropped beyond this until the worker catches up
+#define MAX_CLIENTS           4
+#define ACCEPT_INTERVAL_MS    250  // Worker wakes at least this often to accept clients
+
+#ifndef INVALID_FD
+  #define INVALID_FD  (-1)
+#endif
+
+CEventTap::CEventTap(void) :
+  m_listenFd(INVALID_FD),
+  m_socketDevice(0),
+  m_socketInode(0),
+  m_bHasClients(false),
+  m_sequence(0),
+  m_droppedInQueue(0)
+{
+}
+
+bool CEventTap::IsEnabled(void)
+{
+  const char* path = getenv(TAP_ENVIRONMENT_VARIABLE);
+  return path != nullptr && *path != '\0';
+}
+
+bool CEventTap::Start(void)
+{
+  if (IsRunning())
+    return true;
+
+  const char* path = getenv(TAP_ENVIRONMENT_VARIABLE);
+  if (path == nullptr || *path == '\0')
+    return false;
+
+  sockaddr_un address = { };
+  address.sun_family = AF_UNIX;
+
+  if (strlen(path) >= sizeof(address.sun_path))
+  {
+    esyslog("Event tap path is too long: %s", path);
+    return false;
+  }
+
+  m_path = path;
+  strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+
+  m_listenFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (m_listenFd < 0)
+  {
+    esyslog("Failed to create event tap socket: %s", strerror(errno));
+    return false;
+  }
+
+  if (!RemoveStaleSocket(address))
+  {
+    close(m_listenFd);
+    m_listenFd = INVALID_FD;
+    return false;
+  }
+
+  if (bind(m_listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0)
+  {
+    esyslog("Failed to bind event tap \"%s\": %s", m_path.c_str(), strerror(errno));
+    close(m_listenFd);
+    m_listenFd = INVALID_FD;
+    return false;
+  }
+
+  // Clients can't connect before listen(), so restricting access here has no race
+  struct stat info;
+  if (chmod(m_path.c_str(), S_IRUSR | S_IWUSR) < 0 ||
+      lstat(m_path.c_str(), &info) < 0 ||
+      listen(m_listenFd, MAX_CLIENTS) < 0)
+  {
+    esyslog("Failed to listen on event tap \"%s\": %s", m_path.c_str(), strerror(errno));
+    close(m_listenFd);
+    m_listenFd = INVALID_FD;
+    unlink(m_path.c_str());
+    return false;
+  }
+
+  m_socketDevice = info.st_dev;
+  m_socketInode = info.st_ino;
+
+  if (!CreateThread(false))
+  {
+    esyslog("Failed to start event tap");
+    close(m_listenFd);
+    m_listenFd = INVALID_FD;
+    RemoveSocket();
+    return false;
+  }
+
+  isyslog("Streaming input events to \"%s\"", m_path.c_str());
+
+  return true;
+}
+
+void CEventTap::Stop(void)
+{
+  StopThread(-1);
+  m_queueEvent.Signal();
+  StopThread();
+
+  CloseClients();
+
+  if (m_listenFd >= 0)
+  {
+    close(m_listenFd);
+    m_listenFd = INVALID_FD;
+    RemoveSocket();
+  }
+
+  CLockObject lock(m_queueMutex);
+  m_queue.clear();
+}
+
+void CEventTap::Post(const std::vector<kodi::addon::PeripheralEvent>& events,
+                     std::vector<kodi::addon::PeripheralEvent>::size_type first)
+{
+  if (first >= events.size())
+    return;
+
+  const int64_t timestampUs = GetTimestampUs();
+
+  CLockObject lock(m_queueMutex);
+
+  if (!m_bHasClients)
+    return;
+
+  for (auto i = first; i < events.size(); i++)
+  {
+    const kodi::addon::PeripheralEvent& event = events[i];
+
+    const uint64_t sequence = m_sequence++;
+
+    if (m_queue.size() >= MAX_QUEUED_RECORDS)
+    {
+      m_droppedInQueue++;
+      continue;
+    }
+
+    EventTapRecord record = { };
+
+    record.sequence = sequence;
+    record.timestampUs = timestampUs;
+    record.joystickIndex = event.PeripheralIndex();
+    record.driverIndex = static_cast<uint16_t>(event.DriverIndex());
+    record.type = static_cast<uint8_t>(event.Type());
+
+    switch (event.Type())
+    {
+      case PERIPHERAL_EVENT_TYPE_DRIVER_BUTTON:
+        record.value = event.ButtonState();
+        break;
+      case PERIPHERAL_EVENT_TYPE_DRIVER_HAT:
+        record.value = event.HatState();
+        break;
+      case PERIPHERAL_EVENT_TYPE_DRIVER_AXIS:
+      {
+        const float state = event.AxisState();
+        memcpy(&record.value, &state, sizeof(record.value));
+        break;
+      }
+      default:
+        break;
+    }
+
+    m_queue.push_back(record);
+  }
+
+  m_queueEvent.Signal();
+}
+
+void* CEventTap::Process(void)
+{
+  std::vector<EventTapRecord> records;
+
+  while (!IsStopped())
+  {
+    m_queueEvent.Wait(ACCEPT_INTERVAL_MS);
+
+    if (IsStopped())
+      break;
+
+    AcceptClients();
+
+    uint32_t droppedInQueue;
+    {
+      CLockObject lock(m_queueMutex);
+
+      records.swap(m_queue);
+      droppedInQueue = m_droppedInQueue;
+      m_droppedInQueue = 0;
+      m_bHasClients = !m_clients.empty();
+    }
+
+    if (!records.empty() || droppedInQueue > 0)
+      Send(records, droppedInQueue);
+
+    records.clear();
+  }
+
+  return nullptr;
+}
+
+void CEventTap::AcceptClients(void)
+{
+  int fd;
+  while ((fd = accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+  {
+    if (m_clients.size() >= MAX_CLIENTS)
+    {
+      dsyslog("Event tap: refusing client, %u already connected", MAX_CLIENTS);
+      close(fd);
+      continue;
+    }
+
+    dsyslog("Event tap: client connected");
+    m_clients.push_back({ fd, 0 });
+  }
+}
+
+void CEventTap::Send(const std::vector<EventTapRecord>& records, uint32_t droppedInQueue)
+{
+  for (auto it = m_clients.begin(); it != m_clients.end(); )
+  {
+    Client& client = *it;
+    client.dropped += droppedInQueue;
+
+    bool bConnected = true;
+
+    for (unsigned int i = 0; i < records.size() && bConnected; i += EVENT_TAP_MAX_RECORDS)
+    {
+      const unsigned int count = std::min(static_cast<unsigned int>(records.size()) - i, static_cast<unsigned int>(EVENT_TAP_MAX_RECORDS));
+      bConnected = SendPacket(client, records.data() + i, count);
+    }
+
+    if (bConnected)
+    {
+      ++it;
+    }
+    else
+    {
+      dsyslog("Event tap: client disconnected");
+      close(client.fd);
+      it = m_clients.erase(it);
+    }
+  }
+}
+
+bool CEventTap::SendPacket(Client& client, const EventTapRecord* records, unsigned int count)
+{
+  EventTapPacketHeader header = { };
+
+  header.magic = EVENT_TAP_MAGIC;
+  header.version = EVENT_TAP_VERSION;
+  header.recordCount = static_cast<uint16_t>(count);
+  header.dropped = client.dropped;
+
+  iovec iov[2];
+  iov[0].iov_base = &header;
+  iov[0].iov_len = sizeof(header);
+  iov[1].iov_base = const_cast<EventTapRecord*>(records);
+  iov[1].iov_len = count * sizeof(EventTapRecord);
+
+  msghdr message = { };
+  message.msg_iov = iov;
+  message.msg_iovlen = 2;
+
+  if (sendmsg(client.fd, &message, MSG_DONTWAIT | MSG_NOSIGNAL) < 0)
+  {
+    // A slow client loses records instead of stalling the others
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+    {
+      client.dropped += count;
+      return true;
+    }
+
+    return false;
+  }
+
+  client.dropped = 0;
+
+  return true;
+}
+
+void CEventTap::CloseClients(void)
+{
+  for (const Client& client : m_clients)
+    close(client.fd);
+
+  m_clients.clear();
+
+  CLockObject lock(m_queueMutex);
+  m_bHasClients = false;
+}
+
+bool CEventTap::RemoveStaleSocket(const sockaddr_un& address) const
+{
+  struct stat info;
+  if (lstat(m_path.c_str(), &info) < 0)
+  {
+    if (errno == ENOENT)
+      return true;
+
+    esyslog("Failed to check event tap path \"%s\": %s", m_path.c_str(), strerror(errno));
+    return false;
+  }
+
+  if (!S_ISSOCK(info.st_mode) || info.st_uid != geteuid())
+  {
+    esyslog("Event tap path \"%s\" exists and isn't our socket", m_path.c_str());
+    return false;
+  }
+
+  // A socket that still accepts connections belongs to a running instance
+  const int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+  if (fd >= 0)
+  {
+    const bool bInUse = (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0);
+    close(fd);
+
+    if (bInUse)
+    {
+      esyslog("Event tap \"%s\" is in use by another process", m_path.c_str());
+      return false;
+    }
+  }
+
+  dsyslog("Removing stale event tap socket \"%s\"", m_path.c_str());
+  unlink(m_path.c_str());
+
+  return true;
+}
+
+void CEventTap::RemoveSocket(void)
+{
+  // The path may have been replaced since we bound it
+  struct stat info;
+  if (lstat(m_path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode) &&
+      info.st_dev == m_socketDevice && info.st_ino == m_socketInode)
+  {
+    unlink(m_path.c_str());
+  }
+
+  m_socketDevice = 0;
+  m_socketInode = 0;
+}
+
+int64_t CEventTap::GetTimestampUs(void)
+{
+  timespec now = { };
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<int64_t>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
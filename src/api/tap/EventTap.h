@@ -0,0 +1,119 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "EventTapFormat.h"
+
+#include <kodi/addon-instance/PeripheralUtils.h>
+#include "p8-platform/threads/mutex.h"
+#include "p8-platform/threads/threads.h"
+
+#include <stdint.h>
+#include <string>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <vector>
+
+namespace JOYSTICK
+{
+  /*!
+   * \brief Streams input events to local clients over a UNIX domain socket
+   *
+   * The tap is enabled by setting the environment variable KODI_JOYSTICK_TAP
+   * to a socket path. Clients connect with SOCK_SEQPACKET and receive the
+   * records described in EventTapFormat.h. The socket is only accessible by
+   * its owner. A stale socket at the path is replaced, but nothing else is.
+   *
+   * The input path only copies events into a bounded queue. A worker thread
+   * accepts clients and sends without blocking. Records that don't fit in
+   * the queue or in a client's socket buffer are dropped and counted.
+   */
+  class CEventTap : protected P8PLATFORM::CThread
+  {
+  public:
+    CEventTap(void);
+    virtual ~CEventTap(void) { Stop(); }
+
+    /*!
+     * \brief Check if the tap has been requested
+     */
+    static bool IsEnabled(void);
+
+    /*!
+     * \brief Create the socket and start the worker thread
+     */
+    bool Start(void);
+
+    /*!
+     * \brief Stop the worker thread, disconnect clients and remove the socket
+     */
+    void Stop(void);
+
+    /*!
+     * \brief Queue events for all connected clients
+     *
+     * Never blocks on I/O. Does nothing if no client is connected.
+     */
+    void Post(const std::vector<kodi::addon::PeripheralEvent>& events,
+              std::vector<kodi::addon::PeripheralEvent>::size_type first);
+
+  protected:
+    // implementation of CThread
+    virtual void* Process(void) override;
+
+  private:
+    struct Client
+    {
+      int      fd;
+      uint32_t dropped;
+    };
+
+    void AcceptClients(void);
+    void Send(const std::vector<EventTapRecord>& records, uint32_t droppedInQueue);
+    bool SendPacket(Client& client, const EventTapRecord* records, unsigned int count);
+    void CloseClients(void);
+
+    /*!
+     * \brief Remove a socket left at the path by a previous instance
+     *
+     * \return False if the path is in use or isn't a socket owned by us
+     */
+    bool RemoveStaleSocket(const sockaddr_un& address) const;
+
+    /*!
+     * \brief Remove the socket at the path if it's still the one we bound
+     */
+    void RemoveSocket(void);
+
+    static int64_t GetTimestampUs(void);
+
+    std::string                 m_path;
+    int                         m_listenFd;
+    dev_t                       m_socketDevice; // Identifies the bound socket file
+    ino_t                       m_socketInode;
+    std::vector<Client>         m_clients;      // Only used by the worker
+    bool                        m_bHasClients;  // Checked by Post()
+    uint64_t                    m_sequence;
+    std::vector<EventTapRecord> m_queue;
+    uint32_t                    m_droppedInQueue;
+    P8PLATFORM::CMutex          m_queueMutex;
+    P8PLATFORM::CEvent          m_queueEvent;
+  };
+}
@@ -0,0 +1,69 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*!
+ * Wire format of the event tap
+ *
+ * Each SOCK_SEQPACKET message is an EventTapPacketHeader followed by
+ * recordCount EventTapRecord entries. Values are in host byte order.
+ */
+#define EVENT_TAP_MAGIC        0x50544A4B // "KJTP"
+#define EVENT_TAP_VERSION      1
+#define EVENT_TAP_MAX_RECORDS  256 // Per packet
+
+namespace JOYSTICK
+{
+  struct EventTapPacketHeader
+  {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordCount;
+    uint32_t dropped;  // Records this client missed since its previous packet
+    uint32_t reserved;
+  };
+
+  struct EventTapRecord
+  {
+    uint64_t sequence;      // Increments by one per event, including dropped ones
+    int64_t  timestampUs;   // CLOCK_MONOTONIC time the event was collected
+    uint32_t joystickIndex;
+    uint16_t driverIndex;   // Button, hat, axis or motor index
+    uint8_t  type;          // PERIPHERAL_EVENT_TYPE
+    uint8_t  reserved;
+    uint32_t value;         // Button or hat state, or the bits of a float axis
+    uint32_t padding;       // Keeps the record a multiple of 8 bytes
+  };
+
+  // The layout is shared with clients, so it must not depend on the compiler
+  static_assert(sizeof(EventTapPacketHeader) == 16, "Unexpected packet header size");
+  static_assert(offsetof(EventTapPacketHeader, recordCount) == 6, "Unexpected packet header layout");
+  static_assert(offsetof(EventTapPacketHeader, dropped) == 8, "Unexpected packet header layout");
+
+  static_assert(sizeof(EventTapRecord) == 32, "Unexpected record size");
+  static_assert(offsetof(EventTapRecord, timestampUs) == 8, "Unexpected record layout");
+  static_assert(offsetof(EventTapRecord, joystickIndex) == 16, "Unexpected record layout");
+  static_assert(offsetof(EventTapRecord, driverIndex) == 20, "Unexpected record layout");
+  static_assert(offsetof(EventTapRecord, type) == 22, "Unexpected record layout");
+  static_assert(offsetof(EventTapRecord, value) == 24, "Unexpected record layout");
+}
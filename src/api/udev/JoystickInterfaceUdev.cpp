@@ -39,8 +39,7 @@ ButtonMap CJoystickInterfaceUdev::m_buttonMap = {
 };
 
 CJoystickInterfaceUdev::CJoystickInterfaceUdev() :
-  m_udev(nullptr),
-  m_udev_mon(nullptr)
+  m_udev(nullptr)
 {
 }
 
@@ -55,23 +54,15 @@ bool CJoystickInterfaceUdev::Initialize()
   if (!m_udev)
     return false;
 
-  m_udev_mon = udev_monitor_new_from_netlink(m_udev, "udev");
-  if (m_udev_mon)
-  {
-     udev_monitor_filter_add_match_subsystem_devtype(m_udev_mon, "input", nullptr);
-     udev_monitor_enable_receiving(m_udev_mon);
-  }
+  // Without a monitor, every scan probes for joysticks
+  m_monitor.Initialize(m_udev);
 
   return true;
 }
 
 void CJoystickInterfaceUdev::Deinitialize()
 {
-  if (m_udev_mon)
-  {
-    udev_monitor_unref(m_udev_mon);
-    m_udev_mon = nullptr;
-  }
+  m_monitor.Deinitialize();
 
   if (m_udev)
   {
@@ -112,9 +103,17 @@ bool CJoystickInterfaceUdev::ScanForJoysticks(JoystickVector& joysticks)
   }
 
   udev_enumerate_unref(enumerate);
+
+  m_monitor.ScanCompleted();
+
   return true;
 }
 
+bool CJoystickInterfaceUdev::NeedsScan(void)
+{
+  return m_monitor.HasChanges();
+}
+
 const ButtonMap& CJoystickInterfaceUdev::GetButtonMap()
 {
   auto& dflt = m_buttonMap["game.controller.default"];
@@ -39,11 +39,10 @@
  *  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "JoystickMonitorUdev.h"
 #include "api/IJoystickInterface.h"
 
 struct udev;
-struct udev_device;
-struct udev_monitor;
 
 namespace JOYSTICK
 {
@@ -59,11 +58,12 @@ namespace JOYSTICK
     virtual void Deinitialize() override;
     virtual bool SupportsRumble(void) const { return true; }
     virtual bool ScanForJoysticks(JoystickVector& joysticks) override;
+    virtual bool NeedsScan(void) override;
     virtual const ButtonMap& GetButtonMap() override;
 
   private:
-    udev*         m_udev;
-    udev_monitor* m_udev_mon;
+    udev*                m_udev;
+    CJoystickMonitorUdev m_monitor;
 
     static ButtonMap m_buttonMap;
   };
@@ -0,0 +1,111 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "JoystickMonitorUdev.h"
+#include "log/Log.h"
+
+#include <libudev.h>
+#include <poll.h>
+#include <string.h>
+
+using namespace JOYSTICK;
+
+CJoystickMonitorUdev::CJoystickMonitorUdev(void) :
+  m_monitor(nullptr),
+  m_bChanged(true)
+{
+}
+
+bool CJoystickMonitorUdev::Initialize(udev* udevContext)
+{
+  m_bChanged = true;
+
+  m_monitor = udev_monitor_new_from_netlink(udevContext, "udev");
+  if (m_monitor == nullptr)
+  {
+    esyslog("[udev]: Failed to create monitor, probing for joysticks on every scan");
+    return false;
+  }
+
+  udev_monitor_filter_add_match_subsystem_devtype(m_monitor, "input", nullptr);
+
+  if (udev_monitor_enable_receiving(m_monitor) < 0)
+  {
+    esyslog("[udev]: Failed to receive events, probing for joysticks on every scan");
+    Deinitialize();
+    return false;
+  }
+
+  return true;
+}
+
+void CJoystickMonitorUdev::Deinitialize(void)
+{
+  if (m_monitor != nullptr)
+  {
+    udev_monitor_unref(m_monitor);
+    m_monitor = nullptr;
+  }
+
+  m_bChanged = true;
+}
+
+bool CJoystickMonitorUdev::HasChanges(void)
+{
+  if (m_monitor == nullptr)
+    return true;
+
+  struct pollfd pfd = { udev_monitor_get_fd(m_monitor), POLLIN, 0 };
+
+  // Drain everything that is queued, without waiting for more
+  while (poll(&pfd, 1, 0) > 0)
+  {
+    if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))
+    {
+      // Events may have been lost, so only a scan can tell
+      m_bChanged = true;
+      break;
+    }
+
+    udev_device* dev = udev_monitor_receive_device(m_monitor);
+    if (dev == nullptr)
+      break;
+
+    if (IsJoystick(dev))
+    {
+      const char* action = udev_device_get_action(dev);
+      dsyslog("[udev]: Joystick event \"%s\" for %s", action ? action : "", udev_device_get_devnode(dev));
+      m_bChanged = true;
+    }
+
+    udev_device_unref(dev);
+  }
+
+  return m_bChanged;
+}
+
+bool CJoystickMonitorUdev::IsJoystick(udev_device* dev)
+{
+  // Same criteria as the enumeration in CJoystickInterfaceUdev
+  const char* isJoystick = udev_device_get_property_value(dev, "ID_INPUT_JOYSTICK");
+
+  return isJoystick != nullptr && strcmp(isJoystick, "1") == 0 &&
+         udev_device_get_devnode(dev) != nullptr;
+}
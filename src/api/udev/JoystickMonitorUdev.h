@@ -0,0 +1,69 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+struct udev;
+struct udev_device;
+struct udev_monitor;
+
+namespace JOYSTICK
+{
+  /*!
+   * \brief Watches udev for joysticks being added or removed
+   *
+   * The monitor's netlink socket is drained without blocking, so checking for
+   * changes is cheap enough to do on every frontend scan.
+   */
+  class CJoystickMonitorUdev
+  {
+  public:
+    CJoystickMonitorUdev(void);
+    ~CJoystickMonitorUdev(void) { Deinitialize(); }
+
+    /*!
+     * \brief Start listening for udev events
+     *
+     * \return False if the monitor couldn't be created, in which case changes
+     *         are always reported
+     */
+    bool Initialize(udev* udevContext);
+    void Deinitialize(void);
+
+    /*!
+     * \brief Check if a joystick was added or removed since the last call to
+     *        ScanCompleted()
+     *
+     * Pending events are consumed. Events for other input devices don't
+     * count as changes.
+     */
+    bool HasChanges(void);
+
+    /*!
+     * \brief Record that the joysticks have been enumerated
+     */
+    void ScanCompleted(void) { m_bChanged = false; }
+
+  private:
+    static bool IsJoystick(udev_device* dev);
+
+    udev_monitor* m_monitor;
+    bool          m_bChanged;
+  };
+}
@@ -19,14 +19,20 @@
  */
 
 #include "JoystickUdev.h"
+#include "api/JoystickManager.h"
 #include "api/JoystickTypes.h"
+#include "api/JoystickUtils.h"
 #include "log/Log.h"
+#include "settings/Settings.h"
+
+#include "p8-platform/util/timeutils.h"
 
 #include <algorithm>
 #include <errno.h>
 #include <fcntl.h>
 #include <libudev.h>
 #include <limits.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/ioctl.h>
 #include <sys/stat.h>
@@ -45,6 +51,20 @@ using namespace JOYSTICK;
 // From RetroArch
 #define NBITS(x)  ((((x) - 1) / (sizeof(long) * CHAR_BIT)) + 1)
 
+#define EVENT_BATCH_SIZE  32
+
+namespace
+{
+  int64_t GetTimestampUs(const input_event& event)
+  {
+#if defined(input_event_sec)
+    return static_cast<int64_t>(event.input_event_sec) * 1000000 + event.input_event_usec;
+#else
+    return static_cast<int64_t>(event.time.tv_sec) * 1000000 + event.time.tv_usec;
+#endif
+  }
+}
+
 CJoystickUdev::CJoystickUdev(udev_device* dev, const char* path)
  : CJoystick(EJoystickInterface::UDEV),
    m_dev(dev),
@@ -54,7 +74,14 @@ CJoystickUdev::CJoystickUdev(udev_device* dev, const char* path)
    m_bInitialized(false),
    m_effect(-1),
    m_motors(),
-   m_previousMotors()
+   m_previousMotors(),
+   m_uploadedMotors(),
+   m_lastUploadMs(-1),
+   m_ffIoctlCount(0),
+   m_ffWriteCount(0),
+   m_bRecordingChecked(false),
+   m_ringToken(-1),
+   m_bRingChecked(false)
 {
   // Must initialize in the constructor to fill out joystick properties
   Initialize();
@@ -90,8 +117,26 @@ bool CJoystickUdev::Initialize(void)
 
 void CJoystickUdev::Deinitialize(void)
 {
+  m_recorder.Close();
+
+#if defined(HAVE_IO_URING)
+  if (m_ringToken >= 0)
+  {
+    CJoystickManager::Get().InputRing().Unregister(m_ringToken);
+    m_ringToken = -1;
+  }
+#endif
+
   if (m_fd >= 0)
   {
+    RemoveEffect();
+
+    if (m_ffIoctlCount > 0 || m_ffWriteCount > 0)
+    {
+      dsyslog("[udev]: Rumble on \"%s\": %u effect uploads, %u play/stop writes",
+          Name().c_str(), m_ffIoctlCount, m_ffWriteCount);
+    }
+
     close(m_fd);
     m_fd = INVALID_FD;
   }
@@ -99,7 +144,17 @@ void CJoystickUdev::Deinitialize(void)
   CJoystick::Deinitialize();
 }
 
-void CJoystickUdev::ProcessEvents(void)
+bool CJoystickUdev::GetLegacyAxisLayout(LegacyAxisLayout& layout) const
+{
+  // Only hats were affected by the change
+  if (HatCount() == 0)
+    return false;
+
+  layout = m_legacyAxes;
+  return true;
+}
+
+bool CJoystickUdev::ProcessEvents(void)
 {
   using namespace P8PLATFORM;
 
@@ -112,6 +167,9 @@ void CJoystickUdev::ProcessEvents(void)
     previousMotors = m_previousMotors;
   }
 
+  if (motors == previousMotors)
+    return false;
+
   uint32_t oldStrength = static_cast<uint32_t>(previousMotors[MOTOR_STRONG]) +
                          static_cast<uint32_t>(previousMotors[MOTOR_WEAK]);
   uint32_t newStrength = static_cast<uint32_t>(motors[MOTOR_STRONG]) +
@@ -120,127 +178,216 @@ void CJoystickUdev::ProcessEvents(void)
   bool bWasPlaying = (oldStrength > 0);
   bool bIsPlaying = (newStrength > 0);
 
-  if (!bWasPlaying && !bIsPlaying)
-  {
-    // Nothing to do
-  }
-  else if (!bWasPlaying && bIsPlaying)
+  if (!bWasPlaying && bIsPlaying)
   {
-    UpdateMotorState(motors);
+    // Reuse the uploaded effect if its magnitudes haven't changed
+    if (m_effect < 0 || motors != m_uploadedMotors)
+      UpdateMotorState(motors);
 
     // Play effect
     Play(true);
   }
   else if (bWasPlaying && !bIsPlaying)
   {
-    // Stop the effect
+    // Stop the effect, but keep the slot for the next time rumble starts
     Play(false);
   }
   else
   {
-    if (oldStrength != newStrength)
-      UpdateMotorState(motors);
+    // Coalesce magnitude changes. Starting and stopping is never delayed, but
+    // updates to a playing effect are limited to the configured rate. Skipped
+    // updates remain pending, so the latest magnitudes are applied on a later
+    // call.
+    const unsigned int rateHz = CSettings::Get().RumbleRateHz();
+    if (rateHz > 0 && m_lastUploadMs >= 0)
+    {
+      const int64_t intervalMs = 1000 / rateHz;
+      if (GetTimeMs() - m_lastUploadMs < intervalMs)
+        return true;
+    }
+
+    UpdateMotorState(motors);
   }
 
   {
     CLockObject lock(m_mutex);
     m_previousMotors = motors;
   }
+
+  return false;
 }
 
 void CJoystickUdev::Play(bool bPlayStop)
 {
+  if (m_effect < 0)
+    return;
+
   struct input_event play = { { } };
 
   play.type  = EV_FF;
   play.code  = m_effect;
   play.value = bPlayStop;
 
+  m_ffWriteCount++;
+
   if (write(m_fd, &play, sizeof(play)) < (ssize_t)sizeof(play))
     esyslog("[udev]: Failed to play rumble effect %d on \"%s\" - %s", m_effect, Name().c_str(), strerror(errno));
-
-  if (!bPlayStop)
-    m_effect = -1;
 }
 
-void CJoystickUdev::UpdateMotorState(const std::array<uint16_t, MOTOR_COUNT>& motors)
+bool CJoystickUdev::UpdateMotorState(const std::array<uint16_t, MOTOR_COUNT>& motors)
 {
   struct ff_effect e = { };
 
   e.type                      = FF_RUMBLE;
-  e.id                        = m_effect;
+  e.id                        = m_effect; // -1 allocates a new slot
   e.u.rumble.strong_magnitude = motors[MOTOR_STRONG];
   e.u.rumble.weak_magnitude   = motors[MOTOR_WEAK];
 
+  m_ffIoctlCount++;
+  m_lastUploadMs = P8PLATFORM::GetTimeMs();
+
   if (ioctl(m_fd, EVIOCSFF, &e) < 0)
   {
     esyslog("Failed to set rumble effect %d (0x%04x, 0x%04x) on \"%s\" - %s",
         e.id, e.u.rumble.strong_magnitude, e.u.rumble.weak_magnitude,
         Name().c_str(), strerror(errno));
+    return false;
   }
-  else
+
+  m_effect = e.id;
+  m_uploadedMotors = motors;
+
+  return true;
+}
+
+void CJoystickUdev::RemoveEffect()
+{
+  if (m_effect >= 0)
   {
-    m_effect = e.id;
+    if (ioctl(m_fd, EVIOCRMFF, m_effect) < 0)
+      dsyslog("[udev]: Failed to remove rumble effect %d on \"%s\" - %s", m_effect, Name().c_str(), strerror(errno));
+
+    m_effect = -1;
   }
 }
 
 bool CJoystickUdev::ScanEvents(void)
 {
-  input_event events[32];
+  input_event events[EVENT_BATCH_SIZE];
 
   if (m_fd < 0)
     return false;
 
+  // Only joysticks that are polled get recorded, not every scan result
+  if (!m_bRecordingChecked)
+  {
+    m_bRecordingChecked = true;
+    if (CInputRecorder::IsEnabled())
+      OpenRecording();
+  }
+
+  const bool bRecording = m_recorder.IsOpen();
+
+#if defined(HAVE_IO_URING)
+  CInputRing& inputRing = CJoystickManager::Get().InputRing();
+
+  // Only joysticks that are polled post reads to the ring
+  if (!m_bRingChecked)
+  {
+    m_bRingChecked = true;
+    m_ringToken = inputRing.Register(m_fd, sizeof(events));
+  }
+
+  if (m_ringToken >= 0)
+  {
+    unsigned int readCount;
+    if (inputRing.TakeData(m_ringToken, m_ringData, readCount))
+    {
+      HandleInputEvents(reinterpret_cast<const input_event*>(m_ringData.data()),
+                        m_ringData.size() / sizeof(input_event), bRecording);
+
+      if (bRecording)
+        m_recorder.Flush();
+
+      return true;
+    }
+
+    // Reads failed, fall back to read()
+    inputRing.Unregister(m_ringToken);
+    m_ringToken = -1;
+  }
+#endif
+
   int len;
   while ((len = read(m_fd, events, sizeof(events))) > 0)
+    HandleInputEvents(events, len / sizeof(*events), bRecording);
+
+  if (bRecording)
+    m_recorder.Flush();
+
+  return true;
+}
+
+void CJoystickUdev::HandleInputEvents(const input_event* events, unsigned int count, bool bRecording)
+{
+  for (unsigned int i = 0; i < count; i++)
   {
-    len /= sizeof(*events);
-    for (unsigned int i = 0; i < static_cast<unsigned int>(len); i++)
-    {
-      const input_event& event = events[i];
+    const input_event& event = events[i];
+
+    if (bRecording)
+      m_recorder.Record(GetTimestampUs(event), event.type, event.code, event.value);
 
-      int code = event.code;
+    int code = event.code;
 
-      switch (event.type)
+    switch (event.type)
+    {
+      case EV_KEY:
       {
-        case EV_KEY:
+        if (code >= BTN_MISC || (code >= KEY_UP && code <= KEY_DOWN))
         {
-          if (code >= BTN_MISC || (code >= KEY_UP && code <= KEY_DOWN))
+          auto it = m_button_bind.find(code);
+          if (it != m_button_bind.end())
           {
-            auto it = m_button_bind.find(code);
-            if (it != m_button_bind.end())
-            {
-              const unsigned int buttonIndex = it->second;
-              SetButtonValue(buttonIndex, event.value ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED);
-            }
+            const unsigned int buttonIndex = it->second;
+            SetButtonValue(buttonIndex, event.value ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED);
           }
-          break;
         }
-        case EV_ABS:
+        break;
+      }
+      case EV_ABS:
+      {
+        if (code < ABS_MISC)
         {
-          if (code < ABS_MISC)
+          auto itHat = m_hat_bind.find(code);
+          if (itHat != m_hat_bind.end())
           {
-            auto it = m_axes_bind.find(code);
-            if (it != m_axes_bind.end())
-            {
-              const unsigned int axisIndex = it->second.axisIndex;
-              const input_absinfo& info = it->second.axisInfo;
+            const Hat& hat = itHat->second;
+            JOYSTICK_STATE_HAT& hatState = m_hatStates[hat.hatIndex];
 
-              if (event.value >= 0)
-                SetAxisValue(axisIndex, event.value, info.maximum);
-              else
-                SetAxisValue(axisIndex, event.value, -info.minimum);
+            // One event per change of direction
+            const JOYSTICK_STATE_HAT newState = CJoystickUtils::UpdateHatAxis(hatState, hat.bVertical, event.value, hat.minimum, hat.maximum);
+            if (newState != hatState)
+            {
+              hatState = newState;
+              SetHatValue(hat.hatIndex, hatState);
             }
+            break;
+          }
+
+          auto it = m_axes_bind.find(code);
+          if (it != m_axes_bind.end())
+          {
+            float value;
+            if (it->second.calibration.Apply(event.value, value))
+              SetAxisValue(it->second.axisIndex, value);
           }
-          break;
         }
-        default:
-          break;
+        break;
       }
+      default:
+        break;
     }
   }
-
-  return true;
 }
 
 bool CJoystickUdev::OpenJoystick()
@@ -318,9 +465,37 @@ bool CJoystickUdev::GetProperties()
   }
   SetButtonCount(m_button_bind.size());
 
+  // Hats are reported as pairs of axes, usually with values -1, 0 and 1
+  unsigned int hats = 0;
+  for (unsigned int i = ABS_HAT0X; i <= ABS_HAT3Y; i += 2)
+  {
+    if (test_bit(i, absbit) || test_bit(i + 1, absbit))
+    {
+      m_hat_bind[i] = { hats, false, -1, 1 };
+      m_hat_bind[i + 1] = { hats, true, -1, 1 };
+
+      for (unsigned int code = i; code <= i + 1; code++)
+      {
+        input_absinfo abs;
+        if (test_bit(code, absbit) && ioctl(m_fd, EVIOCGABS(code), &abs) >= 0 && abs.maximum > abs.minimum)
+        {
+          m_hat_bind[code].minimum = abs.minimum;
+          m_hat_bind[code].maximum = abs.maximum;
+        }
+      }
+
+      hats++;
+    }
+  }
+  SetHatCount(hats);
+  m_hatStates.assign(hats, JOYSTICK_STATE_HAT_UNPRESSED);
+
   unsigned int axes = 0;
   for (unsigned i = 0; i < ABS_MISC; i++)
   {
+    if (m_hat_bind.find(i) != m_hat_bind.end())
+      continue;
+
     if (test_bit(i, absbit))
     {
       input_absinfo abs;
@@ -328,11 +503,37 @@ bool CJoystickUdev::GetProperties()
         continue;
 
       if (abs.maximum > abs.minimum)
-        m_axes_bind[i] = { axes++, abs };
+      {
+        Axis axis = { axes++, abs, CAxisCalibration() };
+        axis.calibration.Calibrate(abs.minimum, abs.maximum, abs.flat, abs.fuzz,
+                                   CAxisCalibration::IsEvdevTrigger(i, abs.minimum));
+        m_axes_bind[i] = axis;
+      }
     }
   }
   SetAxisCount(m_axes_bind.size());
 
+  // Before hats were reported as hats, every valid axis below ABS_MISC was
+  // numbered in code order, so hat axes may precede other axes
+  m_legacyAxes.clear();
+  for (unsigned int i = 0; i < ABS_MISC; i++)
+  {
+    auto itAxis = m_axes_bind.find(i);
+    if (itAxis != m_axes_bind.end())
+    {
+      m_legacyAxes.push_back({ false, itAxis->second.axisIndex, false });
+      continue;
+    }
+
+    auto itHat = m_hat_bind.find(i);
+    if (itHat != m_hat_bind.end() && test_bit(i, absbit))
+    {
+      input_absinfo abs;
+      if (ioctl(m_fd, EVIOCGABS(i), &abs) >= 0 && abs.maximum > abs.minimum)
+        m_legacyAxes.push_back({ true, itHat->second.hatIndex, itHat->second.bVertical });
+    }
+  }
+
   // Check for rumble features
   if (ioctl(m_fd, EVIOCGBIT(EV_FF, sizeof(ffbit)), ffbit) >= 0)
   {
@@ -344,6 +545,36 @@ bool CJoystickUdev::GetProperties()
   return true;
 }
 
+void CJoystickUdev::OpenRecording()
+{
+  InputRecordingHeader header;
+
+  header.format      = EInputRecordingFormat::EVDEV;
+  header.name        = Name();
+  header.provider    = Provider();
+  header.vendorId    = VendorID();
+  header.productId   = ProductID();
+  header.buttonCount = ButtonCount();
+  header.hatCount    = HatCount();
+  header.axisCount   = AxisCount();
+
+  for (const auto& button : m_button_bind)
+    header.buttons.push_back({ static_cast<uint16_t>(button.first), static_cast<uint16_t>(button.second) });
+
+  for (const auto& axis : m_axes_bind)
+  {
+    header.axes.push_back({ static_cast<uint16_t>(axis.first), static_cast<uint16_t>(axis.second.axisIndex),
+                            axis.second.axisInfo.minimum, axis.second.axisInfo.maximum,
+                            axis.second.axisInfo.flat, axis.second.axisInfo.fuzz });
+  }
+
+  // Hat axes are stored with the hat index
+  for (const auto& hat : m_hat_bind)
+    header.axes.push_back({ static_cast<uint16_t>(hat.first), static_cast<uint16_t>(hat.second.hatIndex), hat.second.minimum, hat.second.maximum, 0, 0 });
+
+  m_recorder.Open(header);
+}
+
 bool CJoystickUdev::SetMotor(unsigned int motorIndex, float magnitude)
 {
   using namespace P8PLATFORM;
@@ -39,7 +39,9 @@
  *  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "api/AxisCalibration.h"
 #include "api/Joystick.h"
+#include "api/replay/InputRecorder.h"
 
 #include "p8-platform/threads/mutex.h"
 
@@ -47,6 +49,7 @@
 #include <linux/input.h>
 #include <map>
 #include <sys/types.h>
+#include <vector>
 
 struct udev_device;
 
@@ -69,7 +72,9 @@ namespace JOYSTICK
     virtual bool Equals(const CJoystick* rhs) const override;
     virtual bool Initialize(void) override;
     virtual void Deinitialize(void) override;
-    virtual void ProcessEvents(void) override;
+    virtual bool ProcessEvents(void) override;
+    virtual int GetInputFd(void) const override { return m_fd; }
+    virtual bool GetLegacyAxisLayout(LegacyAxisLayout& layout) const override;
 
   protected:
     // implementation of CJoystick
@@ -77,17 +82,30 @@ namespace JOYSTICK
     bool SetMotor(unsigned int motorIndex, float magnitude);
 
   private:
-    void UpdateMotorState(const std::array<uint16_t, MOTOR_COUNT>& motors);
+    bool UpdateMotorState(const std::array<uint16_t, MOTOR_COUNT>& motors);
     void Play(bool bPlayStop);
+    void RemoveEffect();
 
     struct Axis
     {
-      unsigned int  axisIndex;
-      input_absinfo axisInfo;
+      unsigned int     axisIndex;
+      input_absinfo    axisInfo;
+      CAxisCalibration calibration; // Precomputed from the axis info reported by the kernel
     };
 
+    struct Hat
+    {
+      unsigned int hatIndex;
+      bool         bVertical; // ABS_HATnY, otherwise ABS_HATnX
+      int          minimum;
+      int          maximum;
+    };
+
+    void HandleInputEvents(const input_event* events, unsigned int count, bool bRecording);
+
     bool OpenJoystick();
     bool GetProperties();
+    void OpenRecording();
 
     // Udev properties
     udev_device* m_dev;
@@ -95,13 +113,29 @@ namespace JOYSTICK
     dev_t        m_deviceNumber;
     int          m_fd;
     bool         m_bInitialized;
-    int          m_effect;
+    int          m_effect; // Uploaded effect slot, reused until the joystick is closed
 
     // Joystick properties
     std::map<unsigned int, unsigned int> m_button_bind; // Maps keycodes -> button
     std::map<unsigned int, Axis>         m_axes_bind;   // Maps keycodes -> axis and axis info
+    std::map<unsigned int, Hat>          m_hat_bind;    // Maps keycodes -> hat and hat axis
+    LegacyAxisLayout                     m_legacyAxes;  // Axes numbered in code order, hats included
+    std::vector<JOYSTICK_STATE_HAT>      m_hatStates;
     std::array<uint16_t, MOTOR_COUNT>    m_motors;
     std::array<uint16_t, MOTOR_COUNT>    m_previousMotors;
+    std::array<uint16_t, MOTOR_COUNT>    m_uploadedMotors; // Magnitudes of the uploaded effect
+    int64_t                              m_lastUploadMs;
+    unsigned int                         m_ffIoctlCount;
+    unsigned int                         m_ffWriteCount;
     P8PLATFORM::CMutex                   m_mutex;
+
+    // Capture of raw events
+    CInputRecorder                       m_recorder;
+    bool                                 m_bRecordingChecked;
+
+    // Reads through the manager's io_uring, if available
+    int                                  m_ringToken;
+    bool                                 m_bRingChecked;
+    std::vector<uint8_t>                 m_ringData;
   };
 }
@@ -0,0 +1,401 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "InputRing.h"
+#include "log/Log.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <utility>
+
+using namespace JOYSTICK;
+using namespace P8PLATFORM;
+
+#define RING_ENTRIES          128  // Each device has a poll and a read in flight
+#define MAX_DEVICES           32   // Leaves room for cancel requests
+#define MAX_DRAIN_ROUNDS      8    // Reposts per harvest while reads fill their buffer
+#define SHUTDOWN_TIMEOUT_MS   1000 // Reads never block, so this only guards against kernel bugs
+
+#ifndef INVALID_FD
+  #define INVALID_FD  (-1)
+#endif
+
+namespace
+{
+  // User data is the device token times two, plus one for the poll that
+  // precedes each read. Cancel requests use 0.
+  void* ReadData(int token)
+  {
+    return reinterpret_cast<void*>(static_cast<uintptr_t>(token) * 2);
+  }
+
+  void* PollData(int token)
+  {
+    return reinterpret_cast<void*>(static_cast<uintptr_t>(token) * 2 + 1);
+  }
+}
+
+CInputRing::CInputRing(void) :
+  m_ring(),
+  m_bInitialized(false),
+  m_eventFd(INVALID_FD),
+  m_nextToken(1)
+{
+}
+
+bool CInputRing::Initialize(void)
+{
+  CLockObject lock(m_mutex);
+
+  if (m_bInitialized)
+    return true;
+
+  const int ret = io_uring_queue_init(RING_ENTRIES, &m_ring, 0);
+  if (ret < 0)
+  {
+    dsyslog("io_uring unavailable, reading devices directly: %s", strerror(-ret));
+    return false;
+  }
+
+  // Signalled on every completion, so that the input reader can wait for it
+  m_eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (m_eventFd < 0 || io_uring_register_eventfd(&m_ring, m_eventFd) < 0)
+  {
+    dsyslog("io_uring eventfd unavailable, reading devices directly");
+    if (m_eventFd >= 0)
+    {
+      close(m_eventFd);
+      m_eventFd = INVALID_FD;
+    }
+    io_uring_queue_exit(&m_ring);
+    return false;
+  }
+
+  m_bInitialized = true;
+
+  return true;
+}
+
+void CInputRing::Deinitialize(void)
+{
+  CLockObject lock(m_mutex);
+
+  if (!m_bInitialized)
+    return;
+
+  // Cancel the polls. Their linked reads are cancelled with them, and reads
+  // that already started don't block, so every request completes promptly.
+  for (auto it = m_devices.begin(); it != m_devices.end(); )
+  {
+    Device& device = it->second;
+    device.bReleased = true;
+
+    if (device.pending == 0)
+    {
+      it = m_devices.erase(it);
+      continue;
+    }
+
+    Cancel(it->first);
+    ++it;
+  }
+
+  io_uring_submit(&m_ring);
+
+  while (!m_devices.empty())
+  {
+    __kernel_timespec timeout = { };
+    timeout.tv_sec = SHUTDOWN_TIMEOUT_MS / 1000;
+    timeout.tv_nsec = (SHUTDOWN_TIMEOUT_MS % 1000) * 1000 * 1000;
+
+    io_uring_cqe* cqe = nullptr;
+    if (io_uring_wait_cqe_timeout(&m_ring, &cqe, &timeout) < 0 || cqe == nullptr)
+    {
+      // The kernel may still write to the buffers. Leak them rather than
+      // risk corrupting memory that has been reused.
+      esyslog("Timed out waiting for %u device reads, leaking their buffers",
+              static_cast<unsigned int>(m_devices.size()));
+      new std::map<int, Device>(std::move(m_devices));
+      m_devices.clear();
+      break;
+    }
+
+    HandleCompletion(*cqe);
+    io_uring_cqe_seen(&m_ring, cqe);
+  }
+
+  io_uring_queue_exit(&m_ring);
+  m_bInitialized = false;
+
+  close(m_eventFd);
+  m_eventFd = INVALID_FD;
+}
+
+int CInputRing::Register(int fd, unsigned int bufferSize)
+{
+  CLockObject lock(m_mutex);
+
+  if (!m_bInitialized || fd < 0 || bufferSize == 0)
+    return -1;
+
+  if (m_devices.size() >= MAX_DEVICES)
+    return -1;
+
+  const int token = m_nextToken++;
+
+  Device& device = m_devices[token];
+  device.fd = fd;
+  device.buffer.resize(bufferSize);
+  device.pending = 0;
+  device.readCount = 0;
+  device.bFailed = false;
+  device.bReleased = false;
+
+  if (!PostRead(token, device))
+  {
+    m_devices.erase(token);
+    return -1;
+  }
+
+  if (io_uring_submit(&m_ring) < 0)
+  {
+    // The queued requests may still be submitted later, so the buffer must
+    // stay until they complete
+    device.bReleased = true;
+    Cancel(token);
+    return -1;
+  }
+
+  return token;
+}
+
+void CInputRing::Unregister(int token)
+{
+  CLockObject lock(m_mutex);
+
+  auto it = m_devices.find(token);
+  if (it == m_devices.end())
+    return;
+
+  Device& device = it->second;
+
+  if (device.pending == 0)
+  {
+    m_devices.erase(it);
+    return;
+  }
+
+  // The buffer must outlive the posted read. Cancel it and release the
+  // device when all of its requests have completed.
+  device.bReleased = true;
+  device.data.clear();
+
+  Cancel(token);
+  io_uring_submit(&m_ring);
+}
+
+void CInputRing::Harvest(void)
+{
+  CLockObject lock(m_mutex);
+
+  if (!m_bInitialized)
+    return;
+
+  // Clear the eventfd before reaping, so completions posted from now on
+  // signal it again
+  uint64_t count;
+  if (read(m_eventFd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+    esyslog("Failed to clear io_uring eventfd: %s", strerror(errno));
+
+  // Reaping completions doesn't enter the kernel
+  Reap();
+
+  // Repost the reads that completed. Reads of devices with queued input
+  // complete during the submission, so keep collecting and reposting while
+  // reads fill their buffer. The final reposts stay in flight until the
+  // next harvest.
+  for (unsigned int round = 0; round < MAX_DRAIN_ROUNDS; round++)
+  {
+    if (!PostReads())
+      break;
+
+    if (!Reap())
+      break;
+  }
+
+  PostReads();
+}
+
+int CInputRing::GetEventFd(void) const
+{
+  CLockObject lock(m_mutex);
+
+  return m_eventFd;
+}
+
+bool CInputRing::TakeData(int token, std::vector<uint8_t>& data, unsigned int& readCount)
+{
+  CLockObject lock(m_mutex);
+
+  data.clear();
+  readCount = 0;
+
+  auto it = m_devices.find(token);
+  if (it == m_devices.end() || it->second.bReleased)
+    return false;
+
+  Device& device = it->second;
+
+  data.swap(device.data);
+  readCount = device.readCount;
+  device.readCount = 0;
+
+  return !device.bFailed;
+}
+
+bool CInputRing::Reap(void)
+{
+  bool bFilled = false;
+
+  io_uring_cqe* cqe;
+  while (io_uring_peek_cqe(&m_ring, &cqe) == 0 && cqe != nullptr)
+  {
+    if (HandleCompletion(*cqe))
+      bFilled = true;
+    io_uring_cqe_seen(&m_ring, cqe);
+  }
+
+  return bFilled;
+}
+
+bool CInputRing::PostReads(void)
+{
+  std::vector<int> posted;
+
+  for (auto& it : m_devices)
+  {
+    Device& device = it.second;
+    if (device.pending == 0 && !device.bFailed && !device.bReleased)
+    {
+      if (PostRead(it.first, device))
+        posted.push_back(it.first);
+    }
+  }
+
+  if (posted.empty())
+    return false;
+
+  // One submission reposts the reads of every device
+  const int ret = io_uring_submit(&m_ring);
+  if (ret < 0)
+  {
+    // Fall back to read(). The devices keep their buffers until the
+    // requests complete or the ring is destroyed.
+    esyslog("Failed to submit device reads: %s", strerror(-ret));
+    for (int token : posted)
+      m_devices[token].bFailed = true;
+    return false;
+  }
+
+  return true;
+}
+
+bool CInputRing::PostRead(int token, Device& device)
+{
+  // The fd stays non-blocking, so the read waits for input by being linked
+  // to a poll instead of occupying a kernel worker
+  if (io_uring_sq_space_left(&m_ring) < 2)
+    return false;
+
+  io_uring_sqe* sqe = io_uring_get_sqe(&m_ring);
+  io_uring_prep_poll_add(sqe, device.fd, POLLIN);
+  io_uring_sqe_set_data(sqe, PollData(token));
+  sqe->flags |= IOSQE_IO_LINK;
+
+  sqe = io_uring_get_sqe(&m_ring);
+  io_uring_prep_read(sqe, device.fd, device.buffer.data(), device.buffer.size(), 0);
+  io_uring_sqe_set_data(sqe, ReadData(token));
+
+  device.pending += 2;
+
+  return true;
+}
+
+void CInputRing::Cancel(int token)
+{
+  io_uring_sqe* sqe = io_uring_get_sqe(&m_ring);
+  if (sqe != nullptr)
+  {
+    io_uring_prep_cancel(sqe, PollData(token), 0);
+    io_uring_sqe_set_data(sqe, nullptr);
+  }
+}
+
+bool CInputRing::HandleCompletion(const io_uring_cqe& cqe)
+{
+  const uintptr_t userData = reinterpret_cast<uintptr_t>(io_uring_cqe_get_data(&cqe));
+  if (userData == 0)
+    return false; // Cancel request
+
+  const int token = static_cast<int>(userData / 2);
+  const bool bPoll = (userData % 2) != 0;
+
+  auto it = m_devices.find(token);
+  if (it == m_devices.end())
+    return false;
+
+  Device& device = it->second;
+  if (device.pending > 0)
+    device.pending--;
+
+  if (device.bReleased)
+  {
+    if (device.pending == 0)
+      m_devices.erase(it);
+    return false;
+  }
+
+  if (bPoll)
+  {
+    // A failed poll cancels the read, which would otherwise be reposted forever
+    if (cqe.res < 0 && cqe.res != -ECANCELED)
+      device.bFailed = true;
+    return false;
+  }
+
+  if (cqe.res > 0)
+  {
+    device.data.insert(device.data.end(), device.buffer.begin(), device.buffer.begin() + cqe.res);
+    device.readCount++;
+    return static_cast<size_t>(cqe.res) == device.buffer.size();
+  }
+
+  if (cqe.res != -EAGAIN && cqe.res != -EINTR && cqe.res != -ECANCELED)
+  {
+    // E.g. ENODEV after the device was unplugged. The device's own read()
+    // reports the error and the joystick is removed on the next scan.
+    device.bFailed = true;
+  }
+
+  return false;
+}
@@ -0,0 +1,142 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "p8-platform/threads/mutex.h"
+
+#include <liburing.h>
+#include <map>
+#include <stdint.h>
+#include <vector>
+
+namespace JOYSTICK
+{
+  /*!
+   * \brief Reads from all joystick device nodes through a single io_uring
+   *
+   * Every registered fd has one read posted to the ring at all times. Once
+   * per poll, Harvest() collects the completed reads of every device and
+   * reposts them with a single submission, instead of each device looping on
+   * read() until EAGAIN. Reads that fill their buffer are reposted in the
+   * same harvest until the device's queue is drained.
+   *
+   * Registered fds stay non-blocking. Each read is linked to a poll of the
+   * fd, so it waits for input without a kernel worker thread. If the ring
+   * can't be created, or a device's read fails, devices keep using read().
+   */
+  class CInputRing
+  {
+  public:
+    CInputRing(void);
+    ~CInputRing(void) { Deinitialize(); }
+
+    /*!
+     * \brief Create the ring
+     *
+     * \return False if io_uring is unavailable, e.g. on kernels before 5.1
+     */
+    bool Initialize(void);
+
+    /*!
+     * \brief Cancel outstanding reads and destroy the ring
+     *
+     * Waits for every cancelled request to complete. Buffers of requests that
+     * don't complete in time are leaked rather than freed.
+     */
+    void Deinitialize(void);
+
+    /*!
+     * \brief Start reading from a device
+     *
+     * \param fd The device node, which must stay open until Unregister()
+     * \param bufferSize The size of each read, a multiple of the record size
+     *
+     * \return A token for the device, or -1 to keep using read()
+     */
+    int Register(int fd, unsigned int bufferSize);
+
+    /*!
+     * \brief Stop reading from a device
+     */
+    void Unregister(int token);
+
+    /*!
+     * \brief Collect completed reads and repost them
+     */
+    void Harvest(void);
+
+    /*!
+     * \brief Get an fd that becomes readable when reads have completed
+     *        since the last harvest
+     *
+     * \return The fd, or -1 if the ring isn't initialized
+     */
+    int GetEventFd(void) const;
+
+    /*!
+     * \brief Take the data read from a device since the last call
+     *
+     * \param token The token returned by Register()
+     * \param data Receives the data, in the device's record format
+     * \param readCount Receives the number of reads that returned the data
+     *
+     * \return False if reads have failed and the device should unregister
+     *         and fall back to read()
+     */
+    bool TakeData(int token, std::vector<uint8_t>& data, unsigned int& readCount);
+
+  private:
+    struct Device
+    {
+      int                  fd;
+      std::vector<uint8_t> buffer;    // Target of the posted read
+      std::vector<uint8_t> data;      // Completed reads not yet taken
+      unsigned int         pending;   // Completions still expected for the poll and the read
+      unsigned int         readCount; // Completed reads not yet taken
+      bool                 bFailed;
+      bool                 bReleased; // Unregistered, waiting for the requests to finish
+    };
+
+    /*!
+     * \brief Handle all available completions
+     *
+     * \return True if a read filled its buffer and may have left input queued
+     */
+    bool Reap(void);
+
+    /*!
+     * \brief Post and submit reads for all devices without one in flight
+     *
+     * \return True if any reads were submitted
+     */
+    bool PostReads(void);
+
+    bool PostRead(int token, Device& device);
+    void Cancel(int token);
+    bool HandleCompletion(const io_uring_cqe& cqe);
+
+    io_uring                   m_ring;
+    bool                       m_bInitialized;
+    int                        m_eventFd;
+    int                        m_nextToken;
+    std::map<int, Device>      m_devices;
+    mutable P8PLATFORM::CMutex m_mutex;
+  };
+}
@@ -0,0 +1,202 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "JoystickInterfaceVirtual.h"
+#include "JoystickVirtual.h"
+#include "api/JoystickManager.h"
+#include "api/JoystickTypes.h"
+#include "log/Log.h"
+#include "utils/StringUtils.h"
+
+#include <sstream>
+#include <stdlib.h>
+
+using namespace JOYSTICK;
+using namespace P8PLATFORM;
+
+#define VIRTUAL_ENVIRONMENT_VARIABLE  "KODI_JOYSTICK_VIRTUAL"
+#define VIRTUAL_JOYSTICK_NAME         "Virtual Joystick"
+#define MAX_VIRTUAL_JOYSTICKS         4096
+
+CJoystickInterfaceVirtual::CJoystickInterfaceVirtual(void) :
+  m_nextDeviceId(0),
+  m_churnState(88172645u)
+{
+}
+
+bool CJoystickInterfaceVirtual::IsEnabled(void)
+{
+  const char* config = getenv(VIRTUAL_ENVIRONMENT_VARIABLE);
+  return config != nullptr && *config != '\0';
+}
+
+EJoystickInterface CJoystickInterfaceVirtual::Type(void) const
+{
+  return EJoystickInterface::VIRTUAL;
+}
+
+bool CJoystickInterfaceVirtual::Initialize(void)
+{
+  const char* strConfig = getenv(VIRTUAL_ENVIRONMENT_VARIABLE);
+  if (strConfig == nullptr)
+    return false;
+
+  VirtualConfig config;
+  if (!ParseConfig(strConfig, config))
+  {
+    esyslog("Invalid virtual joystick configuration: \"%s\"", strConfig);
+    return false;
+  }
+
+  {
+    CLockObject lock(m_mutex);
+
+    m_config = config;
+
+    for (unsigned int i = 0; i < m_config.count; i++)
+      m_joysticks.push_back(CreateJoystick());
+  }
+
+  isyslog("Created %u virtual joysticks (buttons: %u, hats: %u, axes: %u, rate: %u/s, churn: %ums)",
+      config.count, config.buttons, config.hats, config.axes, config.rate, config.churnMs);
+
+  if (config.churnMs > 0 && config.count > 0)
+  {
+    // Clear a signal left by a previous Deinitialize() without a churn thread
+    m_stopEvent.Reset();
+    CreateThread(false);
+  }
+
+  return true;
+}
+
+void CJoystickInterfaceVirtual::Deinitialize(void)
+{
+  // Wake the churn thread so it doesn't finish its sleep
+  StopThread(-1);
+  m_stopEvent.Signal();
+  StopThread();
+
+  CLockObject lock(m_mutex);
+  m_joysticks.clear();
+}
+
+bool CJoystickInterfaceVirtual::ScanForJoysticks(JoystickVector& joysticks)
+{
+  CLockObject lock(m_mutex);
+
+  joysticks.insert(joysticks.end(), m_joysticks.begin(), m_joysticks.end());
+
+  return true;
+}
+
+void* CJoystickInterfaceVirtual::Process(void)
+{
+  while (!IsStopped())
+  {
+    m_stopEvent.Wait(m_config.churnMs);
+
+    if (IsStopped())
+      break;
+
+    {
+      CLockObject lock(m_mutex);
+
+      if (!m_joysticks.empty())
+      {
+        // xorshift32 to pick the joystick that is unplugged
+        m_churnState ^= m_churnState << 13;
+        m_churnState ^= m_churnState >> 17;
+        m_churnState ^= m_churnState << 5;
+
+        // Replace it with a newly connected device
+        m_joysticks[m_churnState % m_joysticks.size()] = CreateJoystick();
+      }
+    }
+
+    CJoystickManager::Get().SetChanged(true);
+    CJoystickManager::Get().TriggerScan();
+  }
+
+  return nullptr;
+}
+
+bool CJoystickInterfaceVirtual::ParseConfig(const std::string& strConfig, VirtualConfig& config)
+{
+  std::istringstream stream(strConfig);
+  std::string option;
+
+  while (std::getline(stream, option, ','))
+  {
+    StringUtils::Trim(option);
+    if (option.empty())
+      continue;
+
+    const size_t pos = option.find('=');
+    if (pos == std::string::npos)
+      return false;
+
+    std::string key = option.substr(0, pos);
+    std::string strValue = option.substr(pos + 1);
+    StringUtils::Trim(key);
+    StringUtils::Trim(strValue);
+
+    char* end = nullptr;
+    const long value = strtol(strValue.c_str(), &end, 10);
+    if (strValue.empty() || *end != '\0' || value < 0)
+      return false;
+
+    const unsigned int uValue = static_cast<unsigned int>(value);
+
+    if (key == "count")
+      config.count = uValue;
+    else if (key == "buttons")
+      config.buttons = uValue;
+    else if (key == "hats")
+      config.hats = uValue;
+    else if (key == "axes")
+      config.axes = uValue;
+    else if (key == "rate")
+      config.rate = uValue;
+    else if (key == "churn")
+      config.churnMs = uValue;
+    else
+      return false;
+  }
+
+  if (config.count > MAX_VIRTUAL_JOYSTICKS)
+    return false;
+
+  return true;
+}
+
+JoystickPtr CJoystickInterfaceVirtual::CreateJoystick(void)
+{
+  const unsigned int deviceId = m_nextDeviceId++;
+
+  JoystickPtr joystick = std::make_shared<CJoystickVirtual>(deviceId, m_config.rate);
+  // Unique names keep the virtual devices from sharing a button map
+  joystick->SetName(StringUtils::Format("%s %u", VIRTUAL_JOYSTICK_NAME, deviceId));
+  joystick->SetButtonCount(m_config.buttons);
+  joystick->SetHatCount(m_config.hats);
+  joystick->SetAxisCount(m_config.axes);
+
+  return joystick;
+}
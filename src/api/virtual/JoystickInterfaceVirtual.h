@@ -0,0 +1,92 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "api/IJoystickInterface.h"
+
+#include "p8-platform/threads/mutex.h"
+#include "p8-platform/threads/threads.h"
+
+#include <stdint.h>
+#include <string>
+
+namespace JOYSTICK
+{
+  /*!
+   * \brief Interface that provides in-memory joysticks for load testing
+   *
+   * The interface is enabled by setting the environment variable
+   * KODI_JOYSTICK_VIRTUAL to a comma-separated list of options:
+   *
+   *   count=N     Number of joysticks (default 4)
+   *   buttons=N   Buttons per joystick (default 15)
+   *   hats=N      Hats per joystick (default 1)
+   *   axes=N      Axes per joystick (default 6)
+   *   rate=N      Input changes per second per joystick (default 60)
+   *   churn=N     Milliseconds between hotplug events, or 0 to disable (default 0)
+   *
+   * For example, KODI_JOYSTICK_VIRTUAL="count=200,rate=250,churn=1000".
+   */
+  class CJoystickInterfaceVirtual : public IJoystickInterface,
+                                    protected P8PLATFORM::CThread
+  {
+  public:
+    CJoystickInterfaceVirtual(void);
+    virtual ~CJoystickInterfaceVirtual(void) { Deinitialize(); }
+
+    /*!
+     * \brief Check if virtual joysticks have been requested
+     */
+    static bool IsEnabled(void);
+
+    // implementation of IJoystickInterface
+    virtual EJoystickInterface Type(void) const override;
+    virtual bool Initialize(void) override;
+    virtual void Deinitialize(void) override;
+    virtual bool ScanForJoysticks(JoystickVector& joysticks) override;
+    virtual bool NeedsScan(void) override { return false; } // Changes are announced with SetChanged()
+
+  protected:
+    // implementation of CThread
+    virtual void* Process(void) override;
+
+  private:
+    struct VirtualConfig
+    {
+      unsigned int count = 4;
+      unsigned int buttons = 15;
+      unsigned int hats = 1;
+      unsigned int axes = 6;
+      unsigned int rate = 60;
+      unsigned int churnMs = 0;
+    };
+
+    static bool ParseConfig(const std::string& strConfig, VirtualConfig& config);
+
+    JoystickPtr CreateJoystick(void);
+
+    VirtualConfig      m_config;
+    JoystickVector     m_joysticks;
+    unsigned int       m_nextDeviceId;
+    uint32_t           m_churnState;
+    P8PLATFORM::CMutex m_mutex;
+    P8PLATFORM::CEvent m_stopEvent;
+  };
+}
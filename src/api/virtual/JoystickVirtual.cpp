@@ -0,0 +1,128 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "JoystickVirtual.h"
+#include "api/JoystickTypes.h"
+#include "utils/CommonMacros.h"
+
+#include "p8-platform/util/timeutils.h"
+
+using namespace JOYSTICK;
+
+#define MAX_EVENTS_PER_SCAN  1000 // Don't flood the frontend after a stall
+
+CJoystickVirtual::CJoystickVirtual(unsigned int deviceId, unsigned int eventRate)
+ : CJoystick(EJoystickInterface::VIRTUAL),
+   m_deviceId(deviceId),
+   m_eventRate(eventRate),
+   m_lastScanTimeMs(-1),
+   m_pendingEvents(0),
+   m_randomState(2463534242u + deviceId) // Must be non-zero
+{
+}
+
+bool CJoystickVirtual::Equals(const CJoystick* rhs) const
+{
+  const CJoystickVirtual* rhsVirtual = dynamic_cast<const CJoystickVirtual*>(rhs);
+  if (rhsVirtual == nullptr)
+    return false;
+
+  return m_deviceId == rhsVirtual->m_deviceId;
+}
+
+bool CJoystickVirtual::Initialize(void)
+{
+  if (!CJoystick::Initialize())
+    return false;
+
+  m_lastScanTimeMs = -1;
+  m_pendingEvents = 0;
+
+  return true;
+}
+
+bool CJoystickVirtual::ScanEvents(void)
+{
+  const int64_t nowMs = P8PLATFORM::GetTimeMs();
+
+  if (m_lastScanTimeMs >= 0 && nowMs > m_lastScanTimeMs)
+    m_pendingEvents += static_cast<uint64_t>(nowMs - m_lastScanTimeMs) * m_eventRate;
+
+  m_lastScanTimeMs = nowMs;
+
+  uint64_t eventCount = m_pendingEvents / 1000;
+  m_pendingEvents %= 1000;
+
+  if (eventCount > MAX_EVENTS_PER_SCAN)
+    eventCount = MAX_EVENTS_PER_SCAN;
+
+  for (uint64_t i = 0; i < eventCount; i++)
+    GenerateEvent();
+
+  return true;
+}
+
+void CJoystickVirtual::GenerateEvent(void)
+{
+  const unsigned int inputCount = ButtonCount() + HatCount() + AxisCount();
+  if (inputCount == 0)
+    return;
+
+  unsigned int input = Random() % inputCount;
+
+  if (input < ButtonCount())
+  {
+    SetButtonValue(input, (Random() & 1) ? JOYSTICK_STATE_BUTTON_PRESSED : JOYSTICK_STATE_BUTTON_UNPRESSED);
+    return;
+  }
+  input -= ButtonCount();
+
+  if (input < HatCount())
+  {
+    static const JOYSTICK_STATE_HAT hatStates[] =
+    {
+      JOYSTICK_STATE_HAT_UNPRESSED,
+      JOYSTICK_STATE_HAT_UP,
+      JOYSTICK_STATE_HAT_DOWN,
+      JOYSTICK_STATE_HAT_RIGHT,
+      JOYSTICK_STATE_HAT_LEFT,
+      JOYSTICK_STATE_HAT_RIGHT_UP,
+      JOYSTICK_STATE_HAT_RIGHT_DOWN,
+      JOYSTICK_STATE_HAT_LEFT_UP,
+      JOYSTICK_STATE_HAT_LEFT_DOWN,
+    };
+    SetHatValue(input, hatStates[Random() % ARRAY_SIZE(hatStates)]);
+    return;
+  }
+  input -= HatCount();
+
+  // Uniform in [-1.0, 1.0]
+  const float axisValue = static_cast<float>(Random() % 20001) / 10000.0f - 1.0f;
+  SetAxisValue(input, axisValue);
+}
+
+uint32_t CJoystickVirtual::Random(void)
+{
+  // xorshift32, cheap and reproducible per device
+  m_randomState ^= m_randomState << 13;
+  m_randomState ^= m_randomState >> 17;
+  m_randomState ^= m_randomState << 5;
+  return m_randomState;
+}
@@ -0,0 +1,59 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "api/Joystick.h"
+
+#include <stdint.h>
+
+namespace JOYSTICK
+{
+  /*!
+   * \brief In-memory joystick that generates random input
+   */
+  class CJoystickVirtual : public CJoystick
+  {
+  public:
+    /*!
+     * \param deviceId Unique ID of the virtual device
+     * \param eventRate Number of input changes per second
+     */
+    CJoystickVirtual(unsigned int deviceId, unsigned int eventRate);
+    virtual ~CJoystickVirtual(void) { Deinitialize(); }
+
+    // implementation of CJoystick
+    virtual bool Equals(const CJoystick* rhs) const override;
+    virtual bool Initialize(void) override;
+
+  protected:
+    // implementation of CJoystick
+    virtual bool ScanEvents(void) override;
+
+  private:
+    void GenerateEvent(void);
+    uint32_t Random(void);
+
+    const unsigned int m_deviceId;
+    const unsigned int m_eventRate;
+    int64_t            m_lastScanTimeMs;
+    uint64_t           m_pendingEvents; // Events owed since the last scan, in thousandths
+    uint32_t           m_randomState;
+  };
+}
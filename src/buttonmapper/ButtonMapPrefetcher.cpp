@@ -0,0 +1,98 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ButtonMapPrefetcher.h"
+#include "ButtonMapper.h"
+#include "log/Log.h"
+
+using namespace JOYSTICK;
+using namespace P8PLATFORM;
+
+#define MAX_QUEUED_PREFETCHES  16 // Older requests are dropped beyond this
+
+CButtonMapPrefetcher::CButtonMapPrefetcher(CButtonMapper& buttonMapper) :
+  m_buttonMapper(buttonMapper)
+{
+}
+
+bool CButtonMapPrefetcher::Start(void)
+{
+  if (IsRunning())
+    return true;
+
+  if (!CreateThread(false))
+  {
+    esyslog("Failed to start button map prefetcher");
+    return false;
+  }
+
+  return true;
+}
+
+void CButtonMapPrefetcher::Stop(void)
+{
+  StopThread(-1);
+  m_queueEvent.Signal();
+  StopThread();
+
+  CLockObject lock(m_queueMutex);
+  m_queue.clear();
+}
+
+void CButtonMapPrefetcher::Prefetch(const kodi::addon::Joystick& joystick)
+{
+  {
+    CLockObject lock(m_queueMutex);
+
+    if (m_queue.size() >= MAX_QUEUED_PREFETCHES)
+      m_queue.pop_front();
+
+    m_queue.push_back(joystick);
+  }
+
+  m_queueEvent.Signal();
+}
+
+void* CButtonMapPrefetcher::Process(void)
+{
+  while (!IsStopped())
+  {
+    m_queueEvent.Wait();
+
+    while (!IsStopped())
+    {
+      kodi::addon::Joystick joystick;
+
+      {
+        CLockObject lock(m_queueMutex);
+
+        if (m_queue.empty())
+          break;
+
+        joystick = m_queue.front();
+        m_queue.pop_front();
+      }
+
+      m_buttonMapper.PrefetchFeatures(joystick);
+    }
+  }
+
+  return nullptr;
+}
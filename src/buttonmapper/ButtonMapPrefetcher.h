@@ -0,0 +1,74 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "p8-platform/threads/mutex.h"
+#include "p8-platform/threads/threads.h"
+
+#include <kodi/addon-instance/PeripheralUtils.h>
+
+#include <deque>
+
+namespace JOYSTICK
+{
+  class CButtonMapper;
+
+  /*!
+   * \brief Resolves button maps for newly connected joysticks ahead of time
+   *
+   * The frontend asks for features as soon as a joystick appears in a scan.
+   * Devices posted here have their resources resolved in every database and
+   * their most requested controller profiles computed on a worker thread, so
+   * that those first lookups are served from the button mapper's cache.
+   */
+  class CButtonMapPrefetcher : protected P8PLATFORM::CThread
+  {
+  public:
+    CButtonMapPrefetcher(CButtonMapper& buttonMapper);
+    virtual ~CButtonMapPrefetcher(void) { Stop(); }
+
+    /*!
+     * \brief Start the worker thread
+     */
+    bool Start(void);
+
+    /*!
+     * \brief Stop the worker thread and wait for it to exit
+     */
+    void Stop(void);
+
+    /*!
+     * \brief Queue a joystick to be prefetched
+     */
+    void Prefetch(const kodi::addon::Joystick& joystick);
+
+  protected:
+    // implementation of CThread
+    virtual void* Process(void) override;
+
+  private:
+    // Construction parameter
+    CButtonMapper& m_buttonMapper;
+
+    std::deque<kodi::addon::Joystick> m_queue;
+    P8PLATFORM::CMutex                m_queueMutex;
+    P8PLATFORM::CEvent                m_queueEvent;
+  };
+}
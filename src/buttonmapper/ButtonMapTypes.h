@@ -60,6 +60,22 @@ namespace JOYSTICK
    */
   typedef std::map<ControllerID, FeatureVector> ButtonMap;
 
+  /*!
+   * \brief Current location of an axis of a legacy layout, in which hats were
+   *        reported as axes
+   */
+  struct LegacyAxis
+  {
+    bool         bHat;      // Axis belongs to a hat
+    unsigned int index;     // Hat index if bHat is true, otherwise axis index
+    bool         bVertical; // Y axis of a hat
+  };
+
+  /*!
+   * \brief Legacy axis index -> current location of the axis
+   */
+  typedef std::vector<LegacyAxis> LegacyAxisLayout;
+
   /*!
    * \brief Feature translation entry
    */
@@ -109,5 +125,27 @@ namespace JOYSTICK
   typedef std::string FamilyName;
   typedef std::string JoystickName;
 
-  typedef std::map<FamilyName, std::set<JoystickName>> JoystickFamilyMap;
+  /*!
+   * \brief Joystick belonging to a family
+   *
+   * An empty provider matches joysticks from every provider.
+   */
+  struct JoystickFamilyMember
+  {
+    JoystickName name;
+    std::string  provider;
+
+    bool operator<(const JoystickFamilyMember& other) const
+    {
+      if (name < other.name) return true;
+      if (name > other.name) return false;
+
+      if (provider < other.provider) return true;
+      if (provider > other.provider) return false;
+
+      return false;
+    }
+  };
+
+  typedef std::map<FamilyName, std::set<JoystickFamilyMember>> JoystickFamilyMap;
 }
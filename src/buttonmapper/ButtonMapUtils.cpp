@@ -128,6 +128,56 @@ bool ButtonMapUtils::SemiAxisIntersects(const kodi::addon::DriverPrimitive& semi
   return false;
 }
 
+bool ButtonMapUtils::ConvertLegacyHatAxes(kodi::addon::JoystickFeature& feature, const LegacyAxisLayout& layout)
+{
+  bool bConverted = false;
+
+  for (kodi::addon::DriverPrimitive& primitive : feature.Primitives())
+  {
+    if (primitive.Type() != JOYSTICK_DRIVER_PRIMITIVE_TYPE_SEMIAXIS || primitive.DriverIndex() >= layout.size())
+      continue;
+
+    const LegacyAxis& axis = layout[primitive.DriverIndex()];
+
+    if (axis.bHat)
+    {
+      const bool bNegative = primitive.SemiAxisDirection() == JOYSTICK_DRIVER_SEMIAXIS_NEGATIVE;
+
+      JOYSTICK_DRIVER_HAT_DIRECTION direction;
+      if (axis.bVertical)
+        direction = bNegative ? JOYSTICK_DRIVER_HAT_UP : JOYSTICK_DRIVER_HAT_DOWN;
+      else
+        direction = bNegative ? JOYSTICK_DRIVER_HAT_LEFT : JOYSTICK_DRIVER_HAT_RIGHT;
+
+      primitive = kodi::addon::DriverPrimitive(axis.index, direction);
+      bConverted = true;
+    }
+    else if (axis.index != primitive.DriverIndex())
+    {
+      primitive = kodi::addon::DriverPrimitive(axis.index, primitive.Center(), primitive.SemiAxisDirection(), primitive.Range());
+      bConverted = true;
+    }
+  }
+
+  return bConverted;
+}
+
+LegacyAxisLayout ButtonMapUtils::GetLegacyAxisLayout(unsigned int axisCount, unsigned int hatCount)
+{
+  LegacyAxisLayout layout;
+
+  for (unsigned int i = 0; i < axisCount; i++)
+    layout.push_back({ false, i, false });
+
+  for (unsigned int i = 0; i < hatCount; i++)
+  {
+    layout.push_back({ true, i, false });
+    layout.push_back({ true, i, true });
+  }
+
+  return layout;
+}
+
 const std::vector<JOYSTICK_FEATURE_PRIMITIVE>& ButtonMapUtils::GetPrimitives(JOYSTICK_FEATURE_TYPE featureType)
 {
   static const std::map<JOYSTICK_FEATURE_TYPE, std::vector<JOYSTICK_FEATURE_PRIMITIVE>> m_primitiveMap = {
@@ -19,6 +19,8 @@
  */
 #pragma once
 
+#include "ButtonMapTypes.h"
+
 #include <kodi/addon-instance/Peripheral.h>
 
 namespace kodi
@@ -51,6 +53,30 @@ namespace JOYSTICK
      */
     static bool SemiAxisIntersects(const kodi::addon::DriverPrimitive& semiaxis, float point);
 
+    /*!
+     * \brief Convert the axes of a feature saved when udev reported hats as
+     *        axes
+     *
+     * Hat axes become hat directions, and other axes are renumbered to skip
+     * the hats.
+     *
+     * \param layout The location of each legacy axis
+     *
+     * \return True if any primitive was converted
+     */
+    static bool ConvertLegacyHatAxes(kodi::addon::JoystickFeature& feature, const LegacyAxisLayout& layout);
+
+    /*!
+     * \brief Get the legacy layout of a joystick whose axis order is unknown
+     *
+     * Assumes that each hat was reported as two axes (X, then Y) following
+     * the other axes.
+     *
+     * \param axisCount The number of axes, not counting hats
+     * \param hatCount The number of hats
+     */
+    static LegacyAxisLayout GetLegacyAxisLayout(unsigned int axisCount, unsigned int hatCount);
+
     /*!
      * \brief Get a list of all primitives belonging to this feature
      */
@@ -20,17 +20,34 @@
 
 #include "ButtonMapper.h"
 #include "addon.h"
+#include "ButtonMapUtils.h"
 #include "ControllerTransformer.h"
+#include "api/Joystick.h"
+#include "api/JoystickManager.h"
+#include "api/JoystickTranslator.h"
+#include "api/JoystickTypes.h"
 #include "storage/IDatabase.h"
 
+#include "log/Log.h"
+#include "log/Trace.h"
+
 #include <kodi/addon-instance/PeripheralUtils.h>
+#include "p8-platform/util/timeutils.h"
 
 #include <algorithm>
 #include <iterator>
+#include <utility>
 
 using namespace JOYSTICK;
+using namespace P8PLATFORM;
+
+#define FEATURE_CACHE_LIFETIME_MS  2000 // Same as button map resources, which recheck files changed on disk
+#define MAX_CACHED_DEVICES         32
+#define PREFETCH_PROFILE_COUNT     3
+#define DEFAULT_CONTROLLER_ID      "game.controller.default" // Prefetched before any requests are seen
 
 CButtonMapper::CButtonMapper(CPeripheralJoystick* peripheralLib) :
+  m_cacheGeneration(0),
   m_peripheralLib(peripheralLib)
 {
 }
@@ -41,14 +58,20 @@ CButtonMapper::~CButtonMapper()
 
 bool CButtonMapper::Initialize(CJoystickFamilyManager& familyManager)
 {
+  CWriteLock lock(m_databasesLock);
+
   m_controllerTransformer.reset(new CControllerTransformer(familyManager));
   return true;
 }
 
 void CButtonMapper::Deinitialize()
 {
+  CWriteLock lock(m_databasesLock);
+
   m_controllerTransformer.reset();
   m_databases.clear();
+
+  InvalidateFeatures();
 }
 
 IDatabaseCallbacks* CButtonMapper::GetCallbacks()
@@ -60,27 +83,210 @@ bool CButtonMapper::GetFeatures(const kodi::addon::Joystick& joystick,
                                 const std::string& strControllerId,
                                 FeatureVector& features)
 {
+  TRACE_SCOPE("CButtonMapper::GetFeatures");
+
+  const CDevice device(joystick);
+
+  unsigned int generation;
+
+  {
+    CLockObject lock(m_cacheMutex);
+
+    ++m_requestCounts[strControllerId];
+
+    if (GetCachedFeatures(device, strControllerId, features))
+      return !features.empty();
+
+    generation = m_cacheGeneration;
+  }
+
+  CReadLock lock(m_databasesLock);
+
   // Accumulate available button maps for this device
   ButtonMap accumulatedMap = GetButtonMap(joystick);
 
   GetFeatures(joystick, std::move(accumulatedMap), strControllerId, features);
 
+  SetCachedFeatures(device, strControllerId, features, generation);
+
   return !features.empty();
 }
 
+void CButtonMapper::PrefetchFeatures(const kodi::addon::Joystick& joystick)
+{
+  const CDevice device(joystick);
+
+  std::vector<ControllerID> controllerIds;
+  unsigned int generation;
+
+  {
+    CLockObject lock(m_cacheMutex);
+
+    for (const ControllerID& controllerId : GetPrefetchProfiles())
+    {
+      FeatureVector cached;
+      if (!GetCachedFeatures(device, controllerId, cached))
+        controllerIds.push_back(controllerId);
+    }
+
+    generation = m_cacheGeneration;
+  }
+
+  if (controllerIds.empty())
+    return;
+
+  const int64_t startMs = GetTimeMs();
+
+  CReadLock lock(m_databasesLock);
+
+  // Resolves the device's resources in every database
+  const ButtonMap accumulatedMap = GetButtonMap(joystick);
+
+  for (const ControllerID& controllerId : controllerIds)
+  {
+    FeatureVector features;
+    GetFeatures(joystick, accumulatedMap, controllerId, features);
+    SetCachedFeatures(device, controllerId, features, generation);
+  }
+
+  dsyslog("Prefetched %u controller profiles for \"%s\" in %u ms", static_cast<unsigned int>(controllerIds.size()),
+          joystick.Name().c_str(), static_cast<unsigned int>(GetTimeMs() - startMs));
+}
+
+void CButtonMapper::InvalidateFeatures(void)
+{
+  CLockObject lock(m_cacheMutex);
+
+  m_featureCache.clear();
+  ++m_cacheGeneration;
+}
+
+bool CButtonMapper::GetCachedFeatures(const CDevice& device, const std::string& controllerId, FeatureVector& features) const
+{
+  auto itDevice = m_featureCache.find(device);
+  if (itDevice == m_featureCache.end())
+    return false;
+
+  auto itController = itDevice->second.find(controllerId);
+  if (itController == itDevice->second.end())
+    return false;
+
+  const CachedFeatures& cached = itController->second;
+  if (GetTimeMs() >= cached.timestampMs + FEATURE_CACHE_LIFETIME_MS)
+    return false;
+
+  features = cached.features;
+  return true;
+}
+
+void CButtonMapper::SetCachedFeatures(const CDevice& device, const std::string& controllerId, const FeatureVector& features, unsigned int generation)
+{
+  CLockObject lock(m_cacheMutex);
+
+  // Don't store results computed before an invalidation
+  if (generation != m_cacheGeneration)
+    return;
+
+  // Unmapped devices are likely to be mapped soon, so always look them up
+  if (features.empty())
+    return;
+
+  if (m_featureCache.size() >= MAX_CACHED_DEVICES && m_featureCache.find(device) == m_featureCache.end())
+    m_featureCache.clear();
+
+  CachedFeatures& cached = m_featureCache[device][controllerId];
+  cached.features = features;
+  cached.timestampMs = GetTimeMs();
+}
+
+std::vector<ControllerID> CButtonMapper::GetPrefetchProfiles(void) const
+{
+  std::vector<std::pair<unsigned int, ControllerID>> counts;
+
+  for (const auto& requestCount : m_requestCounts)
+    counts.push_back(std::make_pair(requestCount.second, requestCount.first));
+
+  std::sort(counts.begin(), counts.end(),
+    [](const std::pair<unsigned int, ControllerID>& lhs, const std::pair<unsigned int, ControllerID>& rhs)
+    {
+      return lhs.first > rhs.first;
+    });
+
+  std::vector<ControllerID> controllerIds;
+
+  for (const auto& count : counts)
+  {
+    if (controllerIds.size() >= PREFETCH_PROFILE_COUNT)
+      break;
+    controllerIds.push_back(count.second);
+  }
+
+  if (controllerIds.empty())
+    controllerIds.push_back(DEFAULT_CONTROLLER_ID);
+
+  return controllerIds;
+}
+
 ButtonMap CButtonMapper::GetButtonMap(const kodi::addon::Joystick& joystick) const
 {
   ButtonMap accumulatedMap;
 
+  kodi::addon::Joystick legacyJoystick;
+  LegacyAxisLayout legacyLayout;
+  const bool bHasLegacyLayout = GetLegacyHatJoystick(joystick, legacyJoystick, legacyLayout);
+
   for (DatabaseVector::const_iterator it = m_databases.begin(); it != m_databases.end(); ++it)
   {
-    const ButtonMap& buttonMap = (*it)->GetButtonMap(joystick);
+    const ButtonMap buttonMap = (*it)->GetButtonMap(joystick);
     MergeButtonMap(accumulatedMap, buttonMap);
+
+    // Fall back to features saved before hats were reported as hats
+    if (bHasLegacyLayout)
+    {
+      ButtonMap legacyMap = (*it)->GetButtonMap(legacyJoystick);
+      for (auto& controller : legacyMap)
+      {
+        for (kodi::addon::JoystickFeature& feature : controller.second)
+          ButtonMapUtils::ConvertLegacyHatAxes(feature, legacyLayout);
+      }
+      MergeButtonMap(accumulatedMap, legacyMap);
+    }
   }
 
   return accumulatedMap;
 }
 
+bool CButtonMapper::GetLegacyHatJoystick(const kodi::addon::Joystick& joystick, kodi::addon::Joystick& legacyJoystick, LegacyAxisLayout& legacyLayout)
+{
+  // Udev used to report each hat as two axes
+  if (joystick.Provider() != JoystickTranslator::GetInterfaceProvider(EJoystickInterface::UDEV) ||
+      joystick.HatCount() == 0)
+    return false;
+
+  // The axes were numbered in evdev code order, which only a connected
+  // joystick knows
+  bool bFound = false;
+  for (const JoystickPtr& connected : CJoystickManager::Get().GetJoysticks(joystick))
+  {
+    if (connected->AxisCount() == joystick.AxisCount() &&
+        connected->HatCount() == joystick.HatCount() &&
+        connected->GetLegacyAxisLayout(legacyLayout))
+    {
+      bFound = true;
+      break;
+    }
+  }
+
+  if (!bFound)
+    legacyLayout = ButtonMapUtils::GetLegacyAxisLayout(joystick.AxisCount(), joystick.HatCount());
+
+  legacyJoystick = joystick;
+  legacyJoystick.SetHatCount(0);
+  legacyJoystick.SetAxisCount(legacyLayout.size());
+
+  return true;
+}
+
 void CButtonMapper::MergeButtonMap(ButtonMap& accumulatedMap, const ButtonMap& newFeatures)
 {
   for (auto it = newFeatures.begin(); it != newFeatures.end(); ++it)
@@ -190,11 +396,15 @@ void CButtonMapper::DeriveFeatures(const kodi::addon::Joystick& joystick, const
 
 void CButtonMapper::RegisterDatabase(const DatabasePtr& database)
 {
+  CWriteLock lock(m_databasesLock);
+
   if (std::find(m_databases.begin(), m_databases.end(), database) == m_databases.end())
     m_databases.push_back(database);
 }
 
 void CButtonMapper::UnregisterDatabase(const DatabasePtr& database)
 {
+  CWriteLock lock(m_databasesLock);
+
   m_databases.erase(std::remove(m_databases.begin(), m_databases.end(), database), m_databases.end());
 }
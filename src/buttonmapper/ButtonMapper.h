@@ -20,10 +20,17 @@
 #pragma once
 
 #include "ButtonMapTypes.h"
+#include "storage/Device.h"
 #include "storage/StorageTypes.h"
+#include "utils/ReadWriteLock.h"
 
+#include "p8-platform/threads/mutex.h"
+
+#include <map>
 #include <memory>
+#include <stdint.h>
 #include <string>
+#include <unordered_map>
 
 class CPeripheralJoystick;
 
@@ -54,18 +61,55 @@ namespace JOYSTICK
 
     bool GetFeatures(const kodi::addon::Joystick& joystick, const std::string& strDeviceId, FeatureVector& features);
 
+    /*!
+     * \brief Compute and cache features for the controller profiles that are
+     *        requested most often
+     *
+     * Called by the prefetcher for newly connected joysticks.
+     */
+    void PrefetchFeatures(const kodi::addon::Joystick& joystick);
+
+    /*!
+     * \brief Drop all cached features
+     *
+     * Called when any button map changes. Features of other devices may be
+     * derived from the changed map, so all devices are dropped.
+     */
+    void InvalidateFeatures(void);
+
     void RegisterDatabase(const DatabasePtr& database);
     void UnregisterDatabase(const DatabasePtr& database);
 
   private:
     ButtonMap GetButtonMap(const kodi::addon::Joystick& joystick) const;
     static void MergeButtonMap(ButtonMap& accumulatedMap, const ButtonMap& newFeatures);
+    static bool GetLegacyHatJoystick(const kodi::addon::Joystick& joystick, kodi::addon::Joystick& legacyJoystick, LegacyAxisLayout& legacyLayout);
     static void MergeFeatures(FeatureVector& features, const FeatureVector& newFeatures);
     bool GetFeatures(const kodi::addon::Joystick& joystick, ButtonMap buttonMap, const std::string& controllerId, FeatureVector& features);
     void DeriveFeatures(const kodi::addon::Joystick& joystick, const std::string& toController, const ButtonMap& buttonMap, FeatureVector& transformedFeatures);
 
+    bool GetCachedFeatures(const CDevice& device, const std::string& controllerId, FeatureVector& features) const;
+    void SetCachedFeatures(const CDevice& device, const std::string& controllerId, const FeatureVector& features, unsigned int generation);
+    std::vector<ControllerID> GetPrefetchProfiles(void) const;
+
+    struct CachedFeatures
+    {
+      FeatureVector features;
+      int64_t       timestampMs;
+    };
+
+    typedef std::map<ControllerID, CachedFeatures>                        ControllerFeatures;
+    typedef std::unordered_map<CDevice, ControllerFeatures, DeviceHash> FeatureCache;
+
     DatabaseVector    m_databases;
     std::unique_ptr<CControllerTransformer> m_controllerTransformer;
+    CReadWriteLock    m_databasesLock; // Guards the two members above
+
+    // Feature cache
+    FeatureCache                        m_featureCache;
+    std::map<ControllerID, unsigned int> m_requestCounts;
+    unsigned int                        m_cacheGeneration; // Bumped on invalidation
+    mutable P8PLATFORM::CMutex          m_cacheMutex;
 
     CPeripheralJoystick* m_peripheralLib;
   };
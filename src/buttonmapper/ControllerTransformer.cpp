@@ -60,6 +60,8 @@ CControllerTransformer::CControllerTransformer(CJoystickFamilyManager& familyMan
 
 void CControllerTransformer::OnAdd(const DevicePtr& driverInfo, const ButtonMap& buttonMap)
 {
+  P8PLATFORM::CLockObject lock(m_mutex);
+
   // Santity check
   if (m_observedDevices.size() > 200)
     return;
@@ -70,6 +72,10 @@ void CControllerTransformer::OnAdd(const DevicePtr& driverInfo, const ButtonMap&
 
   m_observedDevices.insert(driverInfo);
 
+  const FamilyName family = m_familyManager.GetFamily(driverInfo->Name(), driverInfo->Provider());
+  if (!family.empty())
+    m_familyDevices.insert(std::make_pair(family, driverInfo));
+
   for (auto itTo = buttonMap.begin(); itTo != buttonMap.end(); ++itTo)
   {
     // Only allow controller map items where "from" compares before "to"
@@ -84,12 +90,31 @@ DevicePtr CControllerTransformer::CreateDevice(const CDevice& deviceInfo)
 {
   DevicePtr result = std::make_shared<CDevice>(deviceInfo);
 
+  P8PLATFORM::CLockObject lock(m_mutex);
+
   for (const auto& device : m_observedDevices)
   {
     if (*device == deviceInfo)
     {
       result->Configuration() = device->Configuration();
-      break;
+      return result;
+    }
+  }
+
+  // Devices in the same family with the same layout share a configuration
+  const FamilyName family = m_familyManager.GetFamily(deviceInfo.Name(), deviceInfo.Provider());
+  if (!family.empty())
+  {
+    auto it = m_familyDevices.find(family);
+    if (it != m_familyDevices.end())
+    {
+      const CDevice& familyDevice = *it->second;
+      if (familyDevice.ButtonCount() == deviceInfo.ButtonCount() &&
+          familyDevice.HatCount() == deviceInfo.HatCount() &&
+          familyDevice.AxisCount() == deviceInfo.AxisCount())
+      {
+        result->Configuration() = familyDevice.Configuration();
+      }
     }
   }
 
@@ -169,6 +194,8 @@ void CControllerTransformer::TransformFeatures(const kodi::addon::Joystick& driv
                                                const FeatureVector& features,
                                                FeatureVector& transformedFeatures)
 {
+  P8PLATFORM::CLockObject lock(m_mutex);
+
   const bool bSwap = (fromController >= toController);
 
   ControllerTranslation key = { bSwap ? toController : fromController,
@@ -24,7 +24,9 @@
 #include "storage/IDatabase.h"
 
 #include <kodi/addon-instance/Peripheral.h>
+#include "p8-platform/threads/mutex.h"
 
+#include <map>
 #include <string>
 
 namespace kodi
@@ -77,8 +79,12 @@ namespace JOYSTICK
                              JOYSTICK_FEATURE_PRIMITIVE index,
                              const kodi::addon::DriverPrimitive& primitive);
 
-    ControllerMap           m_controllerMap;
-    DeviceSet               m_observedDevices;
-    CJoystickFamilyManager& m_familyManager;
+    ControllerMap                   m_controllerMap;
+    DeviceSet                       m_observedDevices;
+    std::map<FamilyName, DevicePtr> m_familyDevices; // First device observed in each family
+    CJoystickFamilyManager&         m_familyManager;
+
+    // Databases report button maps from the background indexer
+    P8PLATFORM::CMutex              m_mutex;
   };
 }
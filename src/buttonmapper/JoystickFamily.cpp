@@ -19,10 +19,43 @@
  */
 
 #include "JoystickFamily.h"
+#include "filesystem/FileUtils.h"
+#include "log/Log.h"
+#include "log/Trace.h"
 #include "storage/xml/JoystickFamiliesXml.h"
 #include "storage/xml/JoystickFamilyDefinitions.h"
 
+#include "p8-platform/util/timeutils.h"
+
+#include <time.h>
+
 using namespace JOYSTICK;
+using namespace P8PLATFORM;
+
+#define FAMILIES_REFRESH_INTERVAL_MS  5000 // Limit how often the families file is checked for changes
+
+namespace
+{
+  // The timestamp type of STAT_STRUCTURE differs between platforms and API
+  // versions. Padding bytes make a byte-wise comparison unreliable.
+  template<typename T>
+  bool IsSameTime(const T& lhs, const T& rhs)
+  {
+    return lhs == rhs;
+  }
+
+#if defined(_WIN32)
+  bool IsSameTime(const __timeb64& lhs, const __timeb64& rhs)
+  {
+    return lhs.time == rhs.time && lhs.millitm == rhs.millitm;
+  }
+#else
+  bool IsSameTime(const timespec& lhs, const timespec& rhs)
+  {
+    return lhs.tv_sec == rhs.tv_sec && lhs.tv_nsec == rhs.tv_nsec;
+  }
+#endif
+}
 
 // --- CJoystickFamily ---------------------------------------------------------
 
@@ -43,29 +76,101 @@ bool CJoystickFamily::operator<(const CJoystickFamily& other) const
 
 // --- CJoystickFamilyManager --------------------------------------------------
 
+CJoystickFamilyManager::CJoystickFamilyManager() :
+  m_fileStatus(),
+  m_bHasFileStatus(false),
+  m_lastRefreshMs(-1)
+{
+}
+
 bool CJoystickFamilyManager::Initialize(const std::string& addonPath)
 {
   std::string path = addonPath + "/" JOYSTICK_FAMILIES_FOLDER "/" JOYSTICK_FAMILIES_RESOURCE;
+
+  CLockObject lock(m_mutex);
+
+  m_path = path;
   return LoadFamilies(path);
 }
 
+void CJoystickFamilyManager::Deinitialize()
+{
+  CLockObject lock(m_mutex);
+
+  m_path.clear();
+  m_families.clear();
+  m_familyIndex.clear();
+  m_bHasFileStatus = false;
+  m_lastRefreshMs = -1;
+}
+
 bool CJoystickFamilyManager::LoadFamilies(const std::string& path)
 {
-  CJoystickFamiliesXml::LoadFamilies(path, m_families);
+  TRACE_SCOPE("CJoystickFamilyManager::LoadFamilies");
+
+  m_bHasFileStatus = CFileUtils::Stat(path, m_fileStatus);
+  m_lastRefreshMs = P8PLATFORM::GetTimeMs();
+
+  JoystickFamilyMap families;
+  CJoystickFamiliesXml::LoadFamilies(path, families);
+
+  m_families.swap(families);
+  IndexFamilies();
 
   return !m_families.empty();
 }
 
-const std::string& CJoystickFamilyManager::GetFamily(const std::string& name, const std::string& provider) const
+void CJoystickFamilyManager::RefreshFamilies()
 {
-  static std::string empty;
+  if (m_path.empty())
+    return;
+
+  const int64_t nowMs = P8PLATFORM::GetTimeMs();
+  if (m_lastRefreshMs >= 0 && nowMs - m_lastRefreshMs < FAMILIES_REFRESH_INTERVAL_MS)
+    return;
+
+  m_lastRefreshMs = nowMs;
 
-  for (auto it = m_families.begin(); it != m_families.end(); ++it)
+  STAT_STRUCTURE fileStatus = { };
+  if (!CFileUtils::Stat(m_path, fileStatus))
+    return;
+
+  const bool bChanged = !m_bHasFileStatus ||
+                        fileStatus.size != m_fileStatus.size ||
+                        !IsSameTime(fileStatus.modificationTime, m_fileStatus.modificationTime);
+
+  if (bChanged)
   {
-    const std::set<JoystickName>& joystickNames = it->second;
-    if (joystickNames.find(name) != joystickNames.end())
-      return it->first;
+    dsyslog("Joystick families changed, reloading %s", m_path.c_str());
+    LoadFamilies(m_path);
   }
+}
+
+void CJoystickFamilyManager::IndexFamilies()
+{
+  m_familyIndex.clear();
+
+  for (const auto& family : m_families)
+  {
+    for (const JoystickFamilyMember& member : family.second)
+      m_familyIndex[FamilyKey{ member.name, member.provider }] = family.first;
+  }
+}
+
+std::string CJoystickFamilyManager::GetFamily(const std::string& name, const std::string& provider)
+{
+  CLockObject lock(m_mutex);
+
+  RefreshFamilies();
+
+  // Look for a provider-specific entry first
+  auto it = m_familyIndex.find(FamilyKey{ name, provider });
+
+  if (it == m_familyIndex.end() && !provider.empty())
+    it = m_familyIndex.find(FamilyKey{ name, "" });
+
+  if (it != m_familyIndex.end())
+    return it->second;
 
-  return empty;
+  return "";
 }
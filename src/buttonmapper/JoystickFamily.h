@@ -20,10 +20,16 @@
 #pragma once
 
 #include "ButtonMapTypes.h"
+#include "utils/HashUtils.h"
+
+#include <kodi/Filesystem.h>
+#include "p8-platform/threads/mutex.h"
 
 #include <map>
 #include <set>
+#include <stdint.h>
 #include <string>
+#include <unordered_map>
 
 namespace JOYSTICK
 {
@@ -49,16 +55,57 @@ namespace JOYSTICK
   class CJoystickFamilyManager
   {
   public:
-    CJoystickFamilyManager() = default;
+    CJoystickFamilyManager();
 
     bool Initialize(const std::string& addonPath);
-    void Deinitialize() { m_families.clear(); }
+    void Deinitialize();
 
-    const std::string& GetFamily(const std::string& name, const std::string& provider) const;
+    /*!
+     * \brief Get the family of a joystick
+     *
+     * Joysticks listed without a provider match every provider. The families
+     * file is reloaded if it has changed on disk.
+     *
+     * \param name The joystick's name
+     * \param provider The joystick's provider
+     *
+     * \return The family name, or empty if the joystick isn't in a family
+     */
+    std::string GetFamily(const std::string& name, const std::string& provider);
 
   private:
     bool LoadFamilies(const std::string& path);
+    void RefreshFamilies();
+    void IndexFamilies();
+
+    struct FamilyKey
+    {
+      JoystickName name;
+      std::string  provider;
+
+      bool operator==(const FamilyKey& other) const
+      {
+        return name == other.name && provider == other.provider;
+      }
+    };
+
+    struct FamilyKeyHash
+    {
+      size_t operator()(const FamilyKey& key) const
+      {
+        uint64_t hash = HashUtils::OFFSET_BASIS;
+        HashUtils::HashString(hash, key.name);
+        HashUtils::HashString(hash, key.provider);
+        return static_cast<size_t>(hash);
+      }
+    };
 
-    JoystickFamilyMap m_families;
+    std::string                                              m_path;
+    JoystickFamilyMap                                        m_families;
+    std::unordered_map<FamilyKey, FamilyName, FamilyKeyHash> m_familyIndex; // (name, provider) -> family
+    STAT_STRUCTURE                                           m_fileStatus;
+    bool                                                     m_bHasFileStatus;
+    int64_t                                                  m_lastRefreshMs;
+    P8PLATFORM::CMutex                                       m_mutex;
   };
 }
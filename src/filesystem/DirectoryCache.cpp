@@ -26,8 +26,6 @@
 
 using namespace JOYSTICK;
 
-#define DIRECTORY_LIFETIME_MS  2000 // 2 seconds
-
 // --- Helper function ---------------------------------------------------------
 
 namespace JOYSTICK
@@ -55,6 +53,17 @@ void CDirectoryCache::Deinitialize(void)
 }
 
 bool CDirectoryCache::GetDirectory(const std::string& path, std::vector<kodi::vfs::CDirEntry>& items)
+{
+  if (IsFresh(path))
+  {
+    items = m_cache[path].second;
+    return true;
+  }
+
+  return false;
+}
+
+bool CDirectoryCache::IsFresh(const std::string& path) const
 {
   ItemMap::const_iterator itItemList = m_cache.find(path);
 
@@ -66,11 +75,7 @@ bool CDirectoryCache::GetDirectory(const std::string& path, std::vector<kodi::vf
     const int64_t timestamp = record.first;
     const int64_t expires = timestamp + DIRECTORY_LIFETIME_MS;
 
-    if (expires <= P8PLATFORM::GetTimeMs())
-    {
-      items = record.second;
-      return true;
-    }
+    return P8PLATFORM::GetTimeMs() < expires;
   }
 
   return false;
@@ -26,6 +26,8 @@
 #include <string>
 #include <vector>
 
+#define DIRECTORY_LIFETIME_MS  2000 // 2 seconds
+
 namespace JOYSTICK
 {
   class IDirectoryCacheCallback
@@ -44,6 +46,7 @@ namespace JOYSTICK
     void Deinitialize(void);
 
     bool GetDirectory(const std::string& path, std::vector<kodi::vfs::CDirEntry>& items);
+    bool IsFresh(const std::string& path) const;
     void UpdateDirectory(const std::string& path, const std::vector<kodi::vfs::CDirEntry>& items);
 
   private:
@@ -21,11 +21,14 @@
 #include "Filesystem.h"
 #include "DirectoryUtils.h"
 #include "FileUtils.h"
+#include "log/Trace.h"
 
 using namespace JOYSTICK;
 
 bool CFilesystem::Initialize(void)
 {
+  TRACE_SCOPE("CFilesystem::Initialize");
+
   return CFileUtils::Initialize() &&
          CDirectoryUtils::Initialize();
 }
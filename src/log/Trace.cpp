@@ -0,0 +1,178 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "Trace.h"
+#include "Log.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace JOYSTICK;
+using namespace P8PLATFORM;
+
+#define TRACE_ENVIRONMENT_VARIABLE  "KODI_JOYSTICK_TRACE"
+
+// Spans are only recorded for coarse operations, so this holds hours of
+// activity while bounding memory if something is traced in a loop
+#define MAX_SPAN_COUNT  65536
+
+#define WRITE_INTERVAL_US  (10 * 1000 * 1000) // Between writes triggered by scans
+
+namespace
+{
+  const char* GetTracePath(void)
+  {
+    const char* path = getenv(TRACE_ENVIRONMENT_VARIABLE);
+    return path != nullptr ? path : "";
+  }
+}
+
+CTrace::CTrace(void) :
+  m_bEnabled(*GetTracePath() != '\0'),
+  m_path(GetTracePath()),
+  m_droppedCount(0),
+  m_writtenCount(0),
+  m_lastWriteUs(-1)
+{
+}
+
+CTrace& CTrace::Get(void)
+{
+  static CTrace _instance;
+  return _instance;
+}
+
+int64_t CTrace::GetTimestampUs(void)
+{
+  using namespace std::chrono;
+
+  return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void CTrace::AddSpan(const char* name, int64_t startUs, int64_t endUs)
+{
+  if (!m_bEnabled)
+    return;
+
+  CLockObject lock(m_mutex);
+
+  if (m_spans.size() >= MAX_SPAN_COUNT)
+  {
+    m_droppedCount++;
+    return;
+  }
+
+  auto it = m_threadIds.find(std::this_thread::get_id());
+  if (it == m_threadIds.end())
+  {
+    const unsigned int threadId = static_cast<unsigned int>(m_threadIds.size()) + 1;
+    it = m_threadIds.insert(std::make_pair(std::this_thread::get_id(), threadId)).first;
+  }
+
+  Span span;
+  span.name = name;
+  span.threadId = it->second;
+  span.startUs = startUs;
+  span.durationUs = endUs - startUs;
+
+  m_spans.push_back(span);
+}
+
+bool CTrace::Write(void)
+{
+  if (!m_bEnabled)
+    return false;
+
+  CLockObject writeLock(m_writeMutex);
+
+  std::vector<Span> spans;
+  unsigned int threadCount;
+  unsigned int droppedCount;
+  {
+    CLockObject lock(m_mutex);
+    spans = m_spans;
+    threadCount = static_cast<unsigned int>(m_threadIds.size());
+    droppedCount = m_droppedCount;
+  }
+
+  FILE* file = fopen(m_path.c_str(), "w");
+  if (file == nullptr)
+  {
+    esyslog("Failed to open trace file %s", m_path.c_str());
+    return false;
+  }
+
+  // Span names are literals without characters that need escaping
+  fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+  fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"peripheral.joystick\"}}");
+
+  for (unsigned int threadId = 1; threadId <= threadCount; threadId++)
+  {
+    fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}",
+            threadId, threadId);
+  }
+
+  for (const Span& span : spans)
+  {
+    fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"joystick\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%lld,\"dur\":%lld}",
+            span.name, span.threadId, static_cast<long long>(span.startUs), static_cast<long long>(span.durationUs));
+  }
+
+  fprintf(file, "\n]}\n");
+
+  const bool bSuccess = (ferror(file) == 0);
+  if (fclose(file) != 0 || !bSuccess)
+  {
+    esyslog("Failed to write trace file %s", m_path.c_str());
+    return false;
+  }
+
+  {
+    CLockObject lock(m_mutex);
+    m_writtenCount = spans.size();
+    m_lastWriteUs = GetTimestampUs();
+  }
+
+  if (droppedCount > 0)
+    isyslog("Wrote %u spans to %s (%u dropped)", static_cast<unsigned int>(spans.size()), m_path.c_str(), droppedCount);
+  else
+    isyslog("Wrote %u spans to %s", static_cast<unsigned int>(spans.size()), m_path.c_str());
+
+  return true;
+}
+
+bool CTrace::WriteIfDue(void)
+{
+  if (!m_bEnabled)
+    return false;
+
+  {
+    CLockObject lock(m_mutex);
+
+    if (m_spans.size() == m_writtenCount)
+      return false;
+
+    if (m_lastWriteUs >= 0 && GetTimestampUs() - m_lastWriteUs < WRITE_INTERVAL_US)
+      return false;
+  }
+
+  return Write();
+}
@@ -0,0 +1,136 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "p8-platform/threads/mutex.h"
+
+#include <chrono>
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*!
+ * \brief Record a span covering the rest of the enclosing scope
+ *
+ * The name must be a string literal. Nothing is recorded unless tracing is
+ * enabled.
+ */
+#define TRACE_SCOPE(name)  TRACE_SCOPE_LINE(name, __LINE__)
+
+#define TRACE_SCOPE_LINE(name, line)    TRACE_SCOPE_CONCAT(name, line)
+#define TRACE_SCOPE_CONCAT(name, line)  JOYSTICK::CTraceScope _traceScope ## line(name)
+
+namespace JOYSTICK
+{
+  /*!
+   * \brief Timeline of spans, written as Chrome trace-event JSON
+   *
+   * Tracing is enabled by setting KODI_JOYSTICK_TRACE to the path of the
+   * JSON file. The file is written after the first device scan, rewritten
+   * by later scans at most every few seconds when new spans were recorded,
+   * and written when the add-on is destroyed. It can be opened in
+   * chrome://tracing or Perfetto.
+   */
+  class CTrace
+  {
+  private:
+    CTrace(void);
+
+  public:
+    static CTrace& Get(void);
+
+    /*!
+     * \brief Check if spans are being recorded
+     */
+    bool IsEnabled(void) const { return m_bEnabled; }
+
+    /*!
+     * \brief Get the time used to start and end spans
+     */
+    static int64_t GetTimestampUs(void);
+
+    /*!
+     * \brief Record a finished span on the calling thread
+     */
+    void AddSpan(const char* name, int64_t startUs, int64_t endUs);
+
+    /*!
+     * \brief Write all recorded spans to the trace file
+     *
+     * \return True if the file was written, false if tracing is disabled or
+     *         the file couldn't be written
+     */
+    bool Write(void);
+
+    /*!
+     * \brief Write the trace file if spans were recorded since the last
+     *        write, and the last write isn't too recent
+     *
+     * Called from the scan path, so the input path never writes files.
+     *
+     * \return True if the file was written
+     */
+    bool WriteIfDue(void);
+
+  private:
+    struct Span
+    {
+      const char*  name;
+      unsigned int threadId;
+      int64_t      startUs;
+      int64_t      durationUs;
+    };
+
+    const bool                              m_bEnabled;
+    const std::string                       m_path;
+    std::vector<Span>                       m_spans;
+    std::map<std::thread::id, unsigned int> m_threadIds; // Small numbers are easier to read in the viewer
+    unsigned int                            m_droppedCount;
+    size_t                                  m_writtenCount; // Spans in the file
+    int64_t                                 m_lastWriteUs;  // -1 if never written
+    P8PLATFORM::CMutex                      m_mutex;
+    P8PLATFORM::CMutex                      m_writeMutex;   // Serializes writes of the file
+  };
+
+  /*!
+   * \brief Span that starts on construction and ends on destruction
+   */
+  class CTraceScope
+  {
+  public:
+    explicit CTraceScope(const char* name) :
+      m_name(name),
+      m_startUs(CTrace::Get().IsEnabled() ? CTrace::GetTimestampUs() : -1)
+    {
+    }
+
+    ~CTraceScope(void)
+    {
+      if (m_startUs >= 0)
+        CTrace::Get().AddSpan(m_name, m_startUs, CTrace::GetTimestampUs());
+    }
+
+  private:
+    const char* const m_name;
+    const int64_t     m_startUs;
+  };
+}
@@ -32,10 +32,21 @@ using namespace JOYSTICK;
 #define SETTING_OSX_DRIVER          "driver_osx"
 #define SETTING_XINPUT_DRIVER       "driver_xinput"
 #define SETTING_DIRECTINPUT_DRIVER  "driver_directinput"
+#define SETTING_RUMBLE_RATE         "rumble_rate"
+#define SETTING_SCAN_WINDOW         "scan_window"
+#define SETTING_AXIS_DEADZONE       "axis_deadzone"
+
+#define DEFAULT_RUMBLE_RATE_HZ  30
+#define DEFAULT_SCAN_WINDOW_MS  250
+
+#define MAX_AXIS_DEADZONE_PERCENT  50
 
 CSettings::CSettings(void)
   : m_bInitialized(false),
-    m_bGenerateRetroArchConfigs(false)
+    m_bGenerateRetroArchConfigs(false),
+    m_rumbleRateHz(DEFAULT_RUMBLE_RATE_HZ),
+    m_scanWindowMs(DEFAULT_SCAN_WINDOW_MS),
+    m_axisDeadzone(0.0f)
 {
 }
 
@@ -107,6 +118,33 @@ void CSettings::SetSetting(const std::string& strName, const kodi::CSettingValue
     CJoystickManager::Get().SetEnabled(iface, value.GetBoolean());
     CJoystickManager::Get().TriggerScan();
   }
+  else if (strName == SETTING_RUMBLE_RATE)
+  {
+    const int rumbleRate = value.GetInt();
+    const unsigned int rumbleRateHz = rumbleRate > 0 ? static_cast<unsigned int>(rumbleRate) : 0;
+    m_rumbleRateHz = rumbleRateHz;
+    dsyslog("Setting \"%s\" set to %u", SETTING_RUMBLE_RATE, rumbleRateHz);
+  }
+  else if (strName == SETTING_SCAN_WINDOW)
+  {
+    const int scanWindow = value.GetInt();
+    const unsigned int scanWindowMs = scanWindow > 0 ? static_cast<unsigned int>(scanWindow) : 0;
+    m_scanWindowMs = scanWindowMs;
+    dsyslog("Setting \"%s\" set to %u", SETTING_SCAN_WINDOW, scanWindowMs);
+  }
+  else if (strName == SETTING_AXIS_DEADZONE)
+  {
+    const int deadzonePercent = value.GetInt();
+    float axisDeadzone;
+    if (deadzonePercent <= 0)
+      axisDeadzone = 0.0f;
+    else if (deadzonePercent >= MAX_AXIS_DEADZONE_PERCENT)
+      axisDeadzone = MAX_AXIS_DEADZONE_PERCENT / 100.0f;
+    else
+      axisDeadzone = deadzonePercent / 100.0f;
+    m_axisDeadzone = axisDeadzone;
+    dsyslog("Setting \"%s\" set to %f", SETTING_AXIS_DEADZONE, axisDeadzone);
+  }
 
   m_bInitialized = true;
 }
@@ -19,6 +19,7 @@
  */
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <kodi/General.h>
 
@@ -49,8 +50,35 @@ namespace JOYSTICK
      */
     bool GenerateRetroArchConfigs(void) const { return m_bGenerateRetroArchConfigs; }
 
+    /*!
+     * \brief Maximum number of rumble magnitude updates per second sent to a
+     *        device, or 0 for no limit
+     *
+     * Read by the force-feedback worker.
+     */
+    unsigned int RumbleRateHz(void) const { return m_rumbleRateHz; }
+
+    /*!
+     * \brief Time without further device changes to wait before rescanning,
+     *        or 0 to scan on the first change
+     *
+     * Read by the scan scheduler.
+     */
+    unsigned int ScanWindowMs(void) const { return m_scanWindowMs; }
+
+    /*!
+     * \brief Fraction of the axis range around the center that is reported
+     *        as zero, in the interval [0.0, 0.5]
+     *
+     * Read by the input reader thread.
+     */
+    float AxisDeadzone(void) const { return m_axisDeadzone; }
+
   private:
-    bool        m_bInitialized;
-    bool        m_bGenerateRetroArchConfigs;
+    bool                      m_bInitialized;
+    bool                      m_bGenerateRetroArchConfigs;
+    std::atomic<unsigned int> m_rumbleRateHz;
+    std::atomic<unsigned int> m_scanWindowMs;
+    std::atomic<float>        m_axisDeadzone;
   };
 }
@@ -44,6 +44,19 @@ namespace JOYSTICK
 
     bool IsValid(void) const;
 
+    /*!
+     * \brief Load only the device record (identity and configuration)
+     *
+     * Controller profiles are left unparsed until GetButtonMap() is called.
+     * This is enough to index the resource by device.
+     */
+    virtual bool LoadDevice(void) = 0;
+
+    /*!
+     * \brief True once the controller profiles have been parsed
+     */
+    bool IsLoaded(void) const { return m_timestamp >= 0; }
+
     const ButtonMap& GetButtonMap();
 
     void MapFeatures(const std::string& controllerId, const FeatureVector& features);
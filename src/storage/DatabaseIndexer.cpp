@@ -0,0 +1,75 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DatabaseIndexer.h"
+#include "IDatabase.h"
+#include "log/Log.h"
+
+#include "p8-platform/util/timeutils.h"
+
+using namespace JOYSTICK;
+
+CDatabaseIndexer::CDatabaseIndexer(void) :
+  m_bAbort(false)
+{
+}
+
+bool CDatabaseIndexer::Start(const DatabaseVector& databases)
+{
+  if (IsRunning())
+    return true;
+
+  m_databases = databases;
+  m_bAbort = false;
+
+  if (!CreateThread(false))
+  {
+    esyslog("Failed to start button map indexer");
+    m_databases.clear();
+    return false;
+  }
+
+  return true;
+}
+
+void CDatabaseIndexer::Stop(void)
+{
+  m_bAbort = true;
+  StopThread();
+  m_databases.clear();
+}
+
+void* CDatabaseIndexer::Process(void)
+{
+  const int64_t startMs = P8PLATFORM::GetTimeMs();
+
+  for (auto& database : m_databases)
+  {
+    if (m_bAbort)
+      break;
+
+    database->Preload(m_bAbort);
+  }
+
+  if (!m_bAbort)
+    dsyslog("Indexed button maps in %u ms", static_cast<unsigned int>(P8PLATFORM::GetTimeMs() - startMs));
+
+  return nullptr;
+}
@@ -0,0 +1,63 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "StorageTypes.h"
+
+#include "p8-platform/threads/threads.h"
+
+#include <atomic>
+
+namespace JOYSTICK
+{
+  /*!
+   * \brief Indexes button-map databases in the background
+   *
+   * Started when the storage manager is initialized so that the first
+   * controller connected after boot doesn't pay for enumerating the button
+   * map folders. Queries lock each database as usual, so they wait only for
+   * the database they need and are otherwise served from what has already
+   * been indexed.
+   */
+  class CDatabaseIndexer : protected P8PLATFORM::CThread
+  {
+  public:
+    CDatabaseIndexer(void);
+    virtual ~CDatabaseIndexer(void) { Stop(); }
+
+    /*!
+     * \brief Start preloading the given databases in order
+     */
+    bool Start(const DatabaseVector& databases);
+
+    /*!
+     * \brief Abort preloading and wait for the thread to exit
+     */
+    void Stop(void);
+
+  protected:
+    // implementation of CThread
+    virtual void* Process(void) override;
+
+  private:
+    DatabaseVector    m_databases;
+    std::atomic<bool> m_bAbort;
+  };
+}
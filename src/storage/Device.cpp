@@ -19,6 +19,9 @@
  */
 
 #include "Device.h"
+#include "utils/HashUtils.h"
+
+#include <stdint.h>
 
 using namespace JOYSTICK;
 
@@ -84,6 +87,22 @@ bool CDevice::operator<(const CDevice& rhs) const
   return false;
 }
 
+size_t CDevice::Fingerprint(void) const
+{
+  uint64_t hash = HashUtils::OFFSET_BASIS;
+
+  HashUtils::HashString(hash, Name());
+  HashUtils::HashString(hash, Provider());
+  HashUtils::HashValue(hash, VendorID());
+  HashUtils::HashValue(hash, ProductID());
+  HashUtils::HashValue(hash, ButtonCount());
+  HashUtils::HashValue(hash, HatCount());
+  HashUtils::HashValue(hash, AxisCount());
+  HashUtils::HashValue(hash, Index());
+
+  return static_cast<size_t>(hash);
+}
+
 bool CDevice::SimilarTo(const CDevice& other) const
 {
   if (Provider() != other.Provider())
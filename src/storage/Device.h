@@ -24,6 +24,8 @@
 #include <kodi/addon-instance/Peripheral.h>
 #include <kodi/addon-instance/PeripheralUtils.h>
 
+#include <stddef.h>
+
 namespace JOYSTICK
 {
   /*!
@@ -68,6 +70,14 @@ namespace JOYSTICK
      */
     bool operator<(const CDevice& rhs) const;
 
+    /*!
+     * \brief Hash of the fields compared by operator==
+     *
+     * Equal records have equal fingerprints. Records with equal fingerprints
+     * must still be compared with operator== to rule out collisions.
+     */
+    size_t Fingerprint(void) const;
+
     /*!
      * \brief Define a similarity metric for driver records
      */
@@ -89,4 +99,12 @@ namespace JOYSTICK
   private:
     CDeviceConfiguration m_configuration;
   };
+
+  /*!
+   * \brief Hash functor for unordered containers keyed by device records
+   */
+  struct DeviceHash
+  {
+    size_t operator()(const CDevice& device) const { return device.Fingerprint(); }
+  };
 }
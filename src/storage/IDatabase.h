@@ -22,6 +22,7 @@
 #include "StorageTypes.h"
 #include "buttonmapper/ButtonMapTypes.h"
 
+#include <atomic>
 #include <string>
 
 namespace kodi
@@ -55,8 +56,11 @@ namespace JOYSTICK
 
     /*!
      * \copydoc CStorageManager::GetFeatures()
+     *
+     * Returns a copy, as the database may be updated by another thread once
+     * its lock is released.
      */
-    virtual const ButtonMap& GetButtonMap(const kodi::addon::Joystick& driverInfo) = 0;
+    virtual ButtonMap GetButtonMap(const kodi::addon::Joystick& driverInfo) = 0;
 
     /*!
      * \copydoc CStorageManager::MapFeatures()
@@ -91,6 +95,14 @@ namespace JOYSTICK
     virtual bool ResetButtonMap(const kodi::addon::Joystick& driverInfo,
                                 const std::string& controllerId) = 0;
 
+    /*!
+     * \brief Index the database ahead of the first query
+     *
+     * Called from a background thread at startup. Implementations must lock
+     * as they would for a query, and should return early once bAbort is set.
+     */
+    virtual void Preload(const std::atomic<bool>& bAbort) { }
+
     IDatabaseCallbacks* Callbacks() const { return m_callbacks; }
 
   protected:
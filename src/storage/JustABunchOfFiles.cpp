@@ -56,6 +56,17 @@ DevicePtr CResources::GetDevice(const CDevice& deviceInfo) const
   return device;
 }
 
+std::vector<CDevice> CResources::GetDevices(void) const
+{
+  std::vector<CDevice> devices;
+
+  devices.reserve(m_resources.size());
+  for (const auto& resource : m_resources)
+    devices.push_back(resource.first);
+
+  return devices;
+}
+
 CButtonMap* CResources::GetResource(const CDevice& deviceInfo, bool bCreate)
 {
   CButtonMap* buttonMap = nullptr;
@@ -89,10 +100,23 @@ bool CResources::AddResource(CButtonMap* resource)
 {
   if (resource != nullptr && resource->IsValid())
   {
-    CButtonMap* oldResource = m_resources[*resource->Device()];
-    delete oldResource;
-    m_resources[*resource->Device()] = resource;
-    m_devices[*resource->Device()] = resource->Device();
+    const CDevice& device = *resource->Device();
+
+    // The file may have been rewritten with a different device identity
+    auto itPath = m_resourcePaths.find(resource->Path());
+    if (itPath != m_resourcePaths.end() && itPath->second != device)
+      RemoveResource(resource->Path());
+
+    CButtonMap*& entry = m_resources[device];
+    if (entry != nullptr)
+    {
+      m_resourcePaths.erase(entry->Path());
+      delete entry;
+    }
+    entry = resource;
+
+    m_resourcePaths[resource->Path()] = device;
+    m_devices[device] = resource->Device();
     return true;
   }
   return false;
@@ -100,15 +124,18 @@ bool CResources::AddResource(CButtonMap* resource)
 
 void CResources::RemoveResource(const std::string& strPath)
 {
-  for (ResourceMap::iterator it = m_resources.begin(); it != m_resources.end(); ++it)
+  auto itPath = m_resourcePaths.find(strPath);
+  if (itPath == m_resourcePaths.end())
+    return;
+
+  auto itResource = m_resources.find(itPath->second);
+  if (itResource != m_resources.end())
   {
-    if (it->second->Path() == strPath)
-    {
-      delete it->second;
-      m_resources.erase(it);
-      break;
-    }
+    delete itResource->second;
+    m_resources.erase(itResource);
   }
+
+  m_resourcePaths.erase(itPath);
 }
 
 bool CResources::GetIgnoredPrimitives(const CDevice& deviceInfo, PrimitiveVector& primitives) const
@@ -184,21 +211,21 @@ CJustABunchOfFiles::~CJustABunchOfFiles(void)
   m_directoryCache.Deinitialize();
 }
 
-const ButtonMap& CJustABunchOfFiles::GetButtonMap(const kodi::addon::Joystick& driverInfo)
+ButtonMap CJustABunchOfFiles::GetButtonMap(const kodi::addon::Joystick& driverInfo)
 {
-  static ButtonMap empty;
+  CDevice device(driverInfo);
 
-  CLockObject lock(m_mutex);
+  UpdateIndex();
 
-  // Update index
-  IndexDirectory(m_strResourcePath, FOLDER_DEPTH);
+  CReadLock readLock(m_indexLock);
+  CLockObject lock(GetDeviceLock(device));
 
-  CButtonMap* resource = m_resources.GetResource(driverInfo, false);
+  CButtonMap* resource = m_resources.GetResource(device, false);
 
   if (resource)
-    return resource->GetButtonMap();
+    return LoadButtonMap(resource);
 
-  return empty;
+  return ButtonMap();
 }
 
 bool CJustABunchOfFiles::MapFeatures(const kodi::addon::Joystick& driverInfo,
@@ -208,9 +235,24 @@ bool CJustABunchOfFiles::MapFeatures(const kodi::addon::Joystick& driverInfo,
   if (!m_bReadWrite)
     return false;
 
-  CLockObject lock(m_mutex);
+  CDevice device(driverInfo);
+
+  {
+    CReadLock readLock(m_indexLock);
+    CLockObject lock(GetDeviceLock(device));
+
+    CButtonMap* resource = m_resources.GetResource(device, false);
+    if (resource)
+    {
+      resource->MapFeatures(controllerId, features);
+      return true;
+    }
+  }
+
+  // Creating the resource changes the index
+  CWriteLock writeLock(m_indexLock);
 
-  CButtonMap* resource = m_resources.GetResource(driverInfo, true);
+  CButtonMap* resource = m_resources.GetResource(device, true);
   if (resource)
   {
     resource->MapFeatures(controllerId, features);
@@ -222,12 +264,14 @@ bool CJustABunchOfFiles::MapFeatures(const kodi::addon::Joystick& driverInfo,
 
 bool CJustABunchOfFiles::GetIgnoredPrimitives(const kodi::addon::Joystick& driverInfo, PrimitiveVector& primitives)
 {
-  CLockObject lock(m_mutex);
+  CDevice device(driverInfo);
 
-  // Update index
-  IndexDirectory(m_strResourcePath, FOLDER_DEPTH);
+  UpdateIndex();
+
+  CReadLock readLock(m_indexLock);
+  CLockObject lock(GetDeviceLock(device));
 
-  return m_resources.GetIgnoredPrimitives(driverInfo, primitives);
+  return m_resources.GetIgnoredPrimitives(device, primitives);
 }
 
 bool CJustABunchOfFiles::SetIgnoredPrimitives(const kodi::addon::Joystick& driverInfo, const PrimitiveVector& primitives)
@@ -235,7 +279,8 @@ bool CJustABunchOfFiles::SetIgnoredPrimitives(const kodi::addon::Joystick& drive
   if (!m_bReadWrite)
     return false;
 
-  CLockObject lock(m_mutex);
+  // May create the resource and its backup record
+  CWriteLock writeLock(m_indexLock);
 
   // Ensure resource exists
   m_resources.SetIgnoredPrimitives(driverInfo, primitives);
@@ -250,7 +295,8 @@ bool CJustABunchOfFiles::SaveButtonMap(const kodi::addon::Joystick& driverInfo)
 
   CDevice device(driverInfo);
 
-  CLockObject lock(m_mutex);
+  CReadLock readLock(m_indexLock);
+  CLockObject lock(GetDeviceLock(device));
 
   CButtonMap* resource = m_resources.GetResource(device, false);
 
@@ -267,7 +313,8 @@ bool CJustABunchOfFiles::RevertButtonMap(const kodi::addon::Joystick& driverInfo
 
   CDevice device(driverInfo);
 
-  CLockObject lock(m_mutex);
+  // Removes the backup record
+  CWriteLock writeLock(m_indexLock);
 
   m_resources.Revert(device);
 
@@ -281,7 +328,8 @@ bool CJustABunchOfFiles::ResetButtonMap(const kodi::addon::Joystick& driverInfo,
 
   CDevice deviceInfo(driverInfo);
 
-  CLockObject lock(m_mutex);
+  CReadLock readLock(m_indexLock);
+  CLockObject lock(GetDeviceLock(deviceInfo));
 
   DevicePtr device = m_resources.GetDevice(deviceInfo);
   if (device)
@@ -295,11 +343,60 @@ bool CJustABunchOfFiles::ResetButtonMap(const kodi::addon::Joystick& driverInfo,
   return false;
 }
 
+void CJustABunchOfFiles::Preload(const std::atomic<bool>& bAbort)
+{
+  std::vector<CDevice> devices;
+
+  {
+    CWriteLock writeLock(m_indexLock);
+
+    // Index device headers first so that queries can be answered
+    IndexDirectory(m_strResourcePath, FOLDER_DEPTH);
+
+    devices = m_resources.GetDevices();
+  }
+
+  // Parse profiles for the controller transformer. Only the device being
+  // parsed is locked, so queries for other devices proceed in parallel.
+  for (const CDevice& device : devices)
+  {
+    if (bAbort)
+      break;
+
+    CReadLock readLock(m_indexLock);
+    CLockObject lock(GetDeviceLock(device));
+
+    CButtonMap* resource = m_resources.GetResource(device, false);
+    if (resource && !resource->IsLoaded())
+      LoadButtonMap(resource);
+  }
+}
+
+void CJustABunchOfFiles::UpdateIndex(void)
+{
+  {
+    CReadLock readLock(m_indexLock);
+
+    if (m_directoryCache.IsFresh(m_strResourcePath))
+      return;
+  }
+
+  CWriteLock writeLock(m_indexLock);
+
+  IndexDirectory(m_strResourcePath, FOLDER_DEPTH);
+}
+
+CMutex& CJustABunchOfFiles::GetDeviceLock(const CDevice& device)
+{
+  return m_deviceLocks[device.Fingerprint() % DEVICE_LOCK_SHARDS];
+}
+
 void CJustABunchOfFiles::IndexDirectory(const std::string& path, unsigned int folderDepth)
 {
   // Enumerate the directory
   std::vector<kodi::vfs::CDirEntry> items;
-  if (!m_directoryCache.GetDirectory(path, items))
+  const bool bCached = m_directoryCache.GetDirectory(path, items);
+  if (!bCached)
     CDirectoryUtils::GetDirectory(path, m_strExtension + "|", items);
 
   // Recurse into subdirectories
@@ -315,6 +412,10 @@ void CJustABunchOfFiles::IndexDirectory(const std::string& path, unsigned int fo
     }
   }
 
+  // Cached listings are already filtered and have no changes to report
+  if (bCached)
+    return;
+
   // Erase all folders and resources with different extensions
   items.erase(std::remove_if(items.begin(), items.end(),
     [this](const kodi::vfs::CDirEntry& item)
@@ -325,6 +426,19 @@ void CJustABunchOfFiles::IndexDirectory(const std::string& path, unsigned int fo
   m_directoryCache.UpdateDirectory(path, items);
 }
 
+const ButtonMap& CJustABunchOfFiles::LoadButtonMap(CButtonMap* resource)
+{
+  const bool bWasLoaded = resource->IsLoaded();
+
+  const ButtonMap& buttonMap = resource->GetButtonMap();
+
+  // Profiles are parsed on first use, so report the resource now
+  if (!bWasLoaded && resource->IsLoaded())
+    m_callbacks->OnAdd(resource->Device(), buttonMap);
+
+  return buttonMap;
+}
+
 void CJustABunchOfFiles::OnAdd(const kodi::vfs::CDirEntry& item)
 {
   if (!item.IsFolder())
@@ -332,12 +446,10 @@ void CJustABunchOfFiles::OnAdd(const kodi::vfs::CDirEntry& item)
     // TODO: Switch to unique_ptr or shared_ptr
     CButtonMap* resource = CreateResource(item.Path());
 
-    // Load device info
-    if (resource && resource->Refresh())
+    // Load device info only, profiles are parsed by GetButtonMap()
+    if (resource && resource->LoadDevice())
     {
-      if (m_resources.AddResource(resource))
-        m_callbacks->OnAdd(resource->Device(), resource->GetButtonMap());
-      else
+      if (!m_resources.AddResource(resource))
         delete resource;
     }
     else
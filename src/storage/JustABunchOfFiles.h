@@ -23,12 +23,16 @@
 #include "Device.h"
 #include "IDatabase.h"
 #include "filesystem/DirectoryCache.h"
+#include "utils/ReadWriteLock.h"
 
 #include "p8-platform/threads/mutex.h"
 
-#include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
+
+#define DEVICE_LOCK_SHARDS  16
 
 namespace JOYSTICK
 {
@@ -45,6 +49,11 @@ namespace JOYSTICK
 
     DevicePtr GetDevice(const CDevice& deviceInfo) const;
 
+    /*!
+     * \brief Get the devices of all resources that have been indexed
+     */
+    std::vector<CDevice> GetDevices(void) const;
+
     CButtonMap* GetResource(const CDevice& deviceInfo, bool bCreate);
     bool AddResource(CButtonMap* resource);
     void RemoveResource(const std::string& strPath);
@@ -55,8 +64,9 @@ namespace JOYSTICK
     void Revert(const CDevice& deviceInfo);
 
   private:
-    typedef std::map<CDevice, DevicePtr>   DeviceMap;
-    typedef std::map<CDevice, CButtonMap*> ResourceMap;
+    typedef std::unordered_map<CDevice, DevicePtr, DeviceHash>   DeviceMap;
+    typedef std::unordered_map<CDevice, CButtonMap*, DeviceHash> ResourceMap;
+    typedef std::unordered_map<std::string, CDevice>             PathMap;
 
     // Construction parameters
     const CJustABunchOfFiles* const m_database;
@@ -65,6 +75,7 @@ namespace JOYSTICK
     DeviceMap   m_devices;
     DeviceMap   m_originalDevices;
     ResourceMap m_resources;
+    PathMap     m_resourcePaths; // Resource path -> key into m_resources
   };
 
   class CJustABunchOfFiles : public IDatabase,
@@ -79,7 +90,7 @@ namespace JOYSTICK
     virtual ~CJustABunchOfFiles(void);
 
     // implementation of IDatabase
-    virtual const ButtonMap& GetButtonMap(const kodi::addon::Joystick& driverInfo) override;
+    virtual ButtonMap GetButtonMap(const kodi::addon::Joystick& driverInfo) override;
     virtual bool MapFeatures(const kodi::addon::Joystick& driverInfo,
                              const std::string& controllerId,
                              const FeatureVector& features) override;
@@ -89,6 +100,7 @@ namespace JOYSTICK
     virtual bool RevertButtonMap(const kodi::addon::Joystick& driverInfo) override;
     virtual bool ResetButtonMap(const kodi::addon::Joystick& driverInfo,
                                 const std::string& controllerId) override;
+    virtual void Preload(const std::atomic<bool>& bAbort) override;
 
     // implementation of IDirectoryCacheCallback
     virtual void OnAdd(const kodi::vfs::CDirEntry& item) override;
@@ -110,17 +122,46 @@ namespace JOYSTICK
     DevicePtr CreateDevice(const CDevice& deviceInfo) const;
 
   private:
+    /*!
+     * \brief Re-index the resource path if the directory cache has expired
+     */
+    void UpdateIndex(void);
+
+    /*!
+     * \brief Get the lock guarding the resource of the given device
+     */
+    P8PLATFORM::CMutex& GetDeviceLock(const CDevice& device);
+
     /*!
      * \brief Recursively index a path, enumerating the folder and updating
      *        the directory cache
      */
     void IndexDirectory(const std::string& path, unsigned int folderDepth);
 
+    /*!
+     * \brief Get a resource's button map, parsing its controller profiles
+     *        and reporting it to the database callbacks on first use
+     */
+    const ButtonMap& LoadButtonMap(CButtonMap* resource);
+
     const std::string m_strResourcePath;
     const std::string m_strExtension;
     const bool        m_bReadWrite;
     CDirectoryCache   m_directoryCache;
     CResources        m_resources;
-    P8PLATFORM::CMutex  m_mutex;
+
+    /*!
+     * Locking model:
+     *
+     *   - m_indexLock is held exclusively while the set of resources changes
+     *     (indexing, creating a resource, and backup records) and shared for
+     *     everything else
+     *   - A device's resource and record are only touched while holding both
+     *     a shared m_indexLock and that device's shard in m_deviceLocks
+     *
+     * Lookups for devices in different shards therefore run in parallel.
+     */
+    CReadWriteLock     m_indexLock;
+    P8PLATFORM::CMutex m_deviceLocks[DEVICE_LOCK_SHARDS];
   };
 }
@@ -21,8 +21,10 @@
 #include "StorageManager.h"
 #include "JustABunchOfFiles.h"
 #include "StorageUtils.h"
+#include "buttonmapper/ButtonMapPrefetcher.h"
 #include "buttonmapper/ButtonMapper.h"
 #include "log/Log.h"
+#include "log/Trace.h"
 #include "storage/api/DatabaseJoystickAPI.h"
 //#include "storage/retroarch/DatabaseRetroarch.h" // TODO
 #include "storage/xml/DatabaseXml.h"
@@ -57,12 +59,16 @@ CStorageManager& CStorageManager::Get(void)
 
 bool CStorageManager::Initialize(CPeripheralJoystick* peripheralLib)
 {
+  TRACE_SCOPE("CStorageManager::Initialize");
+
   std::string strUserPath = peripheralLib->UserPath();
   std::string strAddonPath = peripheralLib->AddonPath();
 
   if (peripheralLib == NULL || strUserPath.empty() || strAddonPath.empty())
     return false;
 
+  CWriteLock lock(m_databasesLock);
+
   m_peripheralLib = peripheralLib;
 
   m_buttonMapper.reset(new CButtonMapper(peripheralLib));
@@ -70,6 +76,9 @@ bool CStorageManager::Initialize(CPeripheralJoystick* peripheralLib)
   if (!m_buttonMapper->Initialize(m_familyManager))
     return false;
 
+  m_prefetcher.reset(new CButtonMapPrefetcher(*m_buttonMapper));
+  m_prefetcher->Start();
+
   // Remove slash at end
   StringUtils::TrimRight(strUserPath, "\\/");
   StringUtils::TrimRight(strAddonPath, "\\/");
@@ -98,11 +107,23 @@ bool CStorageManager::Initialize(CPeripheralJoystick* peripheralLib)
 
   m_familyManager.Initialize(strAddonPath);
 
+  // Index button maps before the first controller is connected
+  m_indexer.Start(m_databases);
+
   return true;
 }
 
 void CStorageManager::Deinitialize(void)
 {
+  m_indexer.Stop();
+
+  if (m_prefetcher)
+    m_prefetcher->Stop();
+
+  CWriteLock lock(m_databasesLock);
+
+  m_prefetcher.reset();
+
   m_familyManager.Deinitialize();
   m_databases.clear();
   m_buttonMapper.reset();
@@ -113,24 +134,46 @@ void CStorageManager::GetFeatures(const kodi::addon::Joystick& joystick,
                                   const std::string& strControllerId,
                                   FeatureVector& features)
 {
+  CReadLock lock(m_databasesLock);
+
   if (m_buttonMapper)
     m_buttonMapper->GetFeatures(joystick, strControllerId, features);
 }
 
+void CStorageManager::PrefetchFeatures(const kodi::addon::Joystick& joystick)
+{
+  // The frontend looks up features without a driver index, so prefetch under
+  // the same identity
+  kodi::addon::Joystick frontendJoystick(joystick);
+  frontendJoystick.SetIndex(0);
+
+  CReadLock lock(m_databasesLock);
+
+  if (m_prefetcher)
+    m_prefetcher->Prefetch(frontendJoystick);
+}
+
 bool CStorageManager::MapFeatures(const kodi::addon::Joystick& joystick,
                                   const std::string& strControllerId,
                                   const FeatureVector& features)
 {
+  CReadLock lock(m_databasesLock);
+
   bool bSuccess = false;
 
   for (DatabaseVector::const_iterator it = m_databases.begin(); it != m_databases.end(); ++it)
     bSuccess |= (*it)->MapFeatures(joystick, strControllerId, features);
 
+  if (m_buttonMapper)
+    m_buttonMapper->InvalidateFeatures();
+
   return bSuccess;
 }
 
 void CStorageManager::GetIgnoredPrimitives(const kodi::addon::Joystick& joystick, PrimitiveVector& primitives)
 {
+  CReadLock lock(m_databasesLock);
+
   for (DatabaseVector::const_iterator it = m_databases.begin(); it != m_databases.end(); ++it)
   {
     if ((*it)->GetIgnoredPrimitives(joystick, primitives))
@@ -140,6 +183,8 @@ void CStorageManager::GetIgnoredPrimitives(const kodi::addon::Joystick& joystick
 
 bool CStorageManager::SetIgnoredPrimitives(const kodi::addon::Joystick& joystick, const PrimitiveVector& primitives)
 {
+  CReadLock lock(m_databasesLock);
+
   bool bSuccess = false;
 
   for (DatabaseVector::const_iterator it = m_databases.begin(); it != m_databases.end(); ++it)
@@ -150,6 +195,8 @@ bool CStorageManager::SetIgnoredPrimitives(const kodi::addon::Joystick& joystick
 
 bool CStorageManager::SaveButtonMap(const kodi::addon::Joystick& joystick)
 {
+  CReadLock lock(m_databasesLock);
+
   bool bModified = false;
 
   for (DatabaseVector::const_iterator it = m_databases.begin(); it != m_databases.end(); ++it)
@@ -160,26 +207,43 @@ bool CStorageManager::SaveButtonMap(const kodi::addon::Joystick& joystick)
 
 bool CStorageManager::RevertButtonMap(const kodi::addon::Joystick& joystick)
 {
+  CReadLock lock(m_databasesLock);
+
   bool bModified = false;
 
   for (DatabaseVector::const_iterator it = m_databases.begin(); it != m_databases.end(); ++it)
     bModified |= (*it)->RevertButtonMap(joystick);
 
+  if (m_buttonMapper)
+    m_buttonMapper->InvalidateFeatures();
+
   return bModified;
 }
 
 bool CStorageManager::ResetButtonMap(const kodi::addon::Joystick& joystick, const std::string& strControllerId)
 {
+  CReadLock lock(m_databasesLock);
+
   bool bModified = false;
 
   for (DatabaseVector::const_iterator it = m_databases.begin(); it != m_databases.end(); ++it)
     bModified |= (*it)->ResetButtonMap(joystick, strControllerId);
 
+  if (m_buttonMapper)
+    m_buttonMapper->InvalidateFeatures();
+
   return bModified;
 }
 
 void CStorageManager::RefreshButtonMaps(const std::string& strDeviceName /* = "" */)
 {
+  {
+    CReadLock lock(m_databasesLock);
+
+    if (m_buttonMapper)
+      m_buttonMapper->InvalidateFeatures();
+  }
+
   // Request the frontend to refresh its button maps
   if (m_peripheralLib)
     m_peripheralLib->RefreshButtonMaps(strDeviceName);
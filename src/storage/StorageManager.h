@@ -19,10 +19,12 @@
  */
 #pragma once
 
+#include "DatabaseIndexer.h"
 #include "StorageTypes.h"
 #include "buttonmapper/ButtonMapTypes.h"
 #include "buttonmapper/JoystickFamily.h"
 #include "utils/CommonMacros.h"
+#include "utils/ReadWriteLock.h"
 
 #include <memory>
 #include <string>
@@ -59,6 +61,7 @@ namespace JOYSTICK
     virtual JOYSTICK_FEATURE_TYPE FeatureType(const std::string& strControllerId, const std::string &featureName) = 0;
   };
 
+  class CButtonMapPrefetcher;
   class CButtonMapper;
   class CDevice;
   class IDatabase;
@@ -99,6 +102,13 @@ namespace JOYSTICK
                      const std::string& strDeviceId,
                      FeatureVector& features);
 
+    /*!
+     * \brief Prepare features for a newly connected joystick in the background
+     *
+     * \param joystick      The joystick as it will be reported to the frontend
+     */
+    void PrefetchFeatures(const kodi::addon::Joystick& joystick);
+
     /*!
      * \brief Update button maps
      *
@@ -176,7 +186,10 @@ namespace JOYSTICK
     CPeripheralJoystick* m_peripheralLib;
 
     DatabaseVector                 m_databases;
+    CDatabaseIndexer               m_indexer;
+    CReadWriteLock                 m_databasesLock; // Held exclusively only to (de)initialize
     std::unique_ptr<CButtonMapper> m_buttonMapper;
+    std::unique_ptr<CButtonMapPrefetcher> m_prefetcher;
     CJoystickFamilyManager         m_familyManager;
   };
 }
@@ -24,7 +24,7 @@
 
 using namespace JOYSTICK;
 
-const ButtonMap& CDatabaseJoystickAPI::GetButtonMap(const kodi::addon::Joystick& driverInfo)
+ButtonMap CDatabaseJoystickAPI::GetButtonMap(const kodi::addon::Joystick& driverInfo)
 {
   return CJoystickManager::Get().GetButtonMap(driverInfo.Provider());
 }
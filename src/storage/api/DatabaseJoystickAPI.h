@@ -31,7 +31,7 @@ namespace JOYSTICK
     virtual ~CDatabaseJoystickAPI(void) { }
 
     // implementation of IDatabase
-    virtual const ButtonMap& GetButtonMap(const kodi::addon::Joystick& driverInfo) override;
+    virtual ButtonMap GetButtonMap(const kodi::addon::Joystick& driverInfo) override;
     virtual bool MapFeatures(const kodi::addon::Joystick& driverInfo, const std::string& controllerId, const FeatureVector& features) override;
     virtual bool GetIgnoredPrimitives(const kodi::addon::Joystick& driverInfo, PrimitiveVector& primitives) override;
     virtual bool SetIgnoredPrimitives(const kodi::addon::Joystick& driverInfo, const PrimitiveVector& primitives) override;
@@ -25,6 +25,7 @@
 #include "storage/Device.h"
 #include "storage/StorageManager.h"
 #include "log/Log.h"
+#include "log/Trace.h"
 
 #include "tinyxml.h"
 
@@ -46,29 +47,33 @@ CButtonMapXml::CButtonMapXml(const std::string& strResourcePath, const DevicePtr
 {
 }
 
-bool CButtonMapXml::Load(void)
+bool CButtonMapXml::LoadDevice(void)
 {
   TiXmlDocument xmlFile;
-  if (!xmlFile.LoadFile(m_strResourcePath))
-  {
-    esyslog("Error opening %s: %s", m_strResourcePath.c_str(), xmlFile.ErrorDesc());
+
+  const TiXmlElement* pDevice = OpenDevice(xmlFile);
+  if (!pDevice)
     return false;
-  }
 
-  TiXmlElement* pRootElement = xmlFile.RootElement();
-  if (!pRootElement || pRootElement->NoChildren() || pRootElement->ValueStr() != BUTTONMAP_XML_ROOT)
+  // Don't overwrite valid device
+  if (!m_device->IsValid())
   {
-    esyslog("Can't find root <%s> tag", BUTTONMAP_XML_ROOT);
-    return false;
+    if (!CDeviceXml::Deserialize(pDevice, *m_device))
+      return false;
   }
 
-  const TiXmlElement* pDevice = pRootElement->FirstChildElement(BUTTONMAP_XML_ELEM_DEVICE);
+  return true;
+}
 
+bool CButtonMapXml::Load(void)
+{
+  TRACE_SCOPE("CButtonMapXml::Load");
+
+  TiXmlDocument xmlFile;
+
+  const TiXmlElement* pDevice = OpenDevice(xmlFile);
   if (!pDevice)
-  {
-    esyslog("Can't find <%s> tag", BUTTONMAP_XML_ELEM_DEVICE);
     return false;
-  }
 
   // Don't overwrite valid device
   if (!m_device->IsValid())
@@ -120,8 +125,36 @@ bool CButtonMapXml::Load(void)
   return true;
 }
 
+const TiXmlElement* CButtonMapXml::OpenDevice(TiXmlDocument& xmlFile) const
+{
+  if (!xmlFile.LoadFile(m_strResourcePath))
+  {
+    esyslog("Error opening %s: %s", m_strResourcePath.c_str(), xmlFile.ErrorDesc());
+    return nullptr;
+  }
+
+  TiXmlElement* pRootElement = xmlFile.RootElement();
+  if (!pRootElement || pRootElement->NoChildren() || pRootElement->ValueStr() != BUTTONMAP_XML_ROOT)
+  {
+    esyslog("Can't find root <%s> tag", BUTTONMAP_XML_ROOT);
+    return nullptr;
+  }
+
+  const TiXmlElement* pDevice = pRootElement->FirstChildElement(BUTTONMAP_XML_ELEM_DEVICE);
+
+  if (!pDevice)
+  {
+    esyslog("Can't find <%s> tag", BUTTONMAP_XML_ELEM_DEVICE);
+    return nullptr;
+  }
+
+  return pDevice;
+}
+
 bool CButtonMapXml::Save(void) const
 {
+  TRACE_SCOPE("CButtonMapXml::Save");
+
   TiXmlDocument xmlFile;
 
   TiXmlDeclaration* decl = new TiXmlDeclaration("1.0", "", "");
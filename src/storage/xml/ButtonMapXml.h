@@ -23,6 +23,7 @@
 
 #include <string>
 
+class TiXmlDocument;
 class TiXmlElement;
 
 namespace kodi
@@ -48,12 +49,22 @@ namespace JOYSTICK
 
     virtual ~CButtonMapXml(void) { }
 
+    // implementation of CButtonMap
+    virtual bool LoadDevice(void) override;
+
   protected:
     // implementation of CButtonMap
     virtual bool Load(void) override;
     virtual bool Save(void) const override;
 
   private:
+    /*!
+     * \brief Load the file and locate its <device> element
+     *
+     * \return The element, owned by xmlFile, or nullptr on error
+     */
+    const TiXmlElement* OpenDevice(TiXmlDocument& xmlFile) const;
+
     bool SerializeButtonMaps(TiXmlElement* pElement) const;
 
     bool Serialize(const FeatureVector& features, TiXmlElement* pElement) const;
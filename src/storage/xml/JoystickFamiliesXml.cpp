@@ -68,7 +68,7 @@ bool CJoystickFamiliesXml::Deserialize(const TiXmlElement* pFamily, JoystickFami
       return false;
     }
 
-    std::set<std::string>& family = result[familyName];
+    std::set<JoystickFamilyMember>& family = result[familyName];
 
     const TiXmlElement* pJoystick = pFamily->FirstChildElement(JOYSTICK_FAMILIES_XML_ELEM_JOYSTICK);
 
@@ -91,13 +91,18 @@ bool CJoystickFamiliesXml::Deserialize(const TiXmlElement* pFamily, JoystickFami
   return true;
 }
 
-bool CJoystickFamiliesXml::DeserializeJoysticks(const TiXmlElement* pJoystick, std::set<std::string>& family)
+bool CJoystickFamiliesXml::DeserializeJoysticks(const TiXmlElement* pJoystick, std::set<JoystickFamilyMember>& family)
 {
   while (pJoystick != nullptr)
   {
     const char* joystickName = pJoystick->GetText();
     if (joystickName)
-      family.insert(joystickName);
+    {
+      // Provider is optional
+      const char* provider = pJoystick->Attribute(JOYSTICK_FAMILIES_XML_ATTR_PROVIDER);
+
+      family.insert(JoystickFamilyMember{ joystickName, provider != nullptr ? provider : "" });
+    }
 
     pJoystick = pJoystick->NextSiblingElement(JOYSTICK_FAMILIES_XML_ELEM_JOYSTICK);
   }
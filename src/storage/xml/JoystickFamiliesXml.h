@@ -32,6 +32,6 @@ namespace JOYSTICK
 
   private:
     static bool Deserialize(const TiXmlElement* pFamily, JoystickFamilyMap& result);
-    static bool DeserializeJoysticks(const TiXmlElement* pJoystick, std::set<std::string>& family);
+    static bool DeserializeJoysticks(const TiXmlElement* pJoystick, std::set<JoystickFamilyMember>& family);
   };
 }
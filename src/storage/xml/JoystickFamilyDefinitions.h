@@ -27,3 +27,4 @@
 #define JOYSTICK_FAMILIES_XML_ELEM_JOYSTICK     "joystick"
 
 #define JOYSTICK_FAMILIES_XML_ATTR_FAMILY_NAME  "name"
+#define JOYSTICK_FAMILIES_XML_ATTR_PROVIDER     "provider"
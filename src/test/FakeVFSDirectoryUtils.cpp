@@ -0,0 +1,47 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/vfs/VFSDirectoryUtils.h"
+
+using namespace JOYSTICK;
+
+// In-memory stand-in for the frontend's VFS, which isn't available to the
+// tests. Every directory exists and is empty.
+
+bool CVFSDirectoryUtils::Create(const std::string& path)
+{
+  return true;
+}
+
+bool CVFSDirectoryUtils::Exists(const std::string& path)
+{
+  return true;
+}
+
+bool CVFSDirectoryUtils::Remove(const std::string& path)
+{
+  return true;
+}
+
+bool CVFSDirectoryUtils::GetDirectory(const std::string& path, const std::string& mask, std::vector<kodi::vfs::CDirEntry>& items)
+{
+  items.clear();
+  return true;
+}
@@ -0,0 +1,171 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "api/AxisCalibration.h"
+
+#include <gtest/gtest.h>
+
+using namespace JOYSTICK;
+
+TEST(TestAxisCalibration, TriggerClassification)
+{
+  // Signed axes are never triggers
+  EXPECT_FALSE(CAxisCalibration::IsEvdevTrigger(0x02, -32768)); // ABS_Z
+  EXPECT_FALSE(CAxisCalibration::IsEvdevTrigger(0x03, -32768)); // ABS_RX
+
+  // Unsigned sticks
+  EXPECT_FALSE(CAxisCalibration::IsEvdevTrigger(0x00, 0)); // ABS_X
+  EXPECT_FALSE(CAxisCalibration::IsEvdevTrigger(0x01, 0)); // ABS_Y
+
+  // Other unsigned axes rest at their minimum
+  EXPECT_TRUE(CAxisCalibration::IsEvdevTrigger(0x02, 0)); // ABS_Z
+  EXPECT_TRUE(CAxisCalibration::IsEvdevTrigger(0x03, 0)); // ABS_RX (DS4 on hid-sony)
+  EXPECT_TRUE(CAxisCalibration::IsEvdevTrigger(0x04, 0)); // ABS_RY (DS4 on hid-sony)
+  EXPECT_TRUE(CAxisCalibration::IsEvdevTrigger(0x05, 0)); // ABS_RZ
+  EXPECT_TRUE(CAxisCalibration::IsEvdevTrigger(0x06, 0)); // ABS_THROTTLE
+  EXPECT_TRUE(CAxisCalibration::IsEvdevTrigger(0x09, 0)); // ABS_GAS
+  EXPECT_TRUE(CAxisCalibration::IsEvdevTrigger(0x0a, 0)); // ABS_BRAKE
+}
+
+TEST(TestAxisCalibration, HidTriggerWithFlatZone)
+{
+  // hid-input gives generic gamepad axes a flat of (max - min) >> 4
+  const int minimum = 0;
+  const int maximum = 255;
+  const int flat = (maximum - minimum) >> 4;
+
+  CAxisCalibration calibration;
+  calibration.Calibrate(minimum, maximum, flat, 0, CAxisCalibration::IsEvdevTrigger(0x02, minimum)); // ABS_Z
+
+  float value;
+
+  // Rests at 0 like before calibration was introduced
+  ASSERT_TRUE(calibration.Apply(0, value));
+  EXPECT_FLOAT_EQ(0.0f, value);
+
+  // The flat zone isn't applied at the minimum
+  ASSERT_TRUE(calibration.Apply(flat, value));
+  EXPECT_FLOAT_EQ(flat / 255.0f, value);
+
+  ASSERT_TRUE(calibration.Apply(128, value));
+  EXPECT_FLOAT_EQ(128 / 255.0f, value);
+
+  ASSERT_TRUE(calibration.Apply(255, value));
+  EXPECT_FLOAT_EQ(1.0f, value);
+}
+
+TEST(TestAxisCalibration, SignedStick)
+{
+  CAxisCalibration calibration;
+  calibration.Calibrate(-32768, 32767, 0, 0, false);
+
+  float value;
+
+  ASSERT_TRUE(calibration.Apply(0, value));
+  EXPECT_FLOAT_EQ(0.0f, value);
+
+  ASSERT_TRUE(calibration.Apply(32767, value));
+  EXPECT_FLOAT_EQ(1.0f, value);
+
+  ASSERT_TRUE(calibration.Apply(-32768, value));
+  EXPECT_FLOAT_EQ(-1.0f, value);
+}
+
+TEST(TestAxisCalibration, UnsignedStickIsCentered)
+{
+  CAxisCalibration calibration;
+  calibration.Calibrate(0, 255, 0, 0, false);
+
+  float value;
+
+  ASSERT_TRUE(calibration.Apply(0, value));
+  EXPECT_FLOAT_EQ(-1.0f, value);
+
+  ASSERT_TRUE(calibration.Apply(255, value));
+  EXPECT_FLOAT_EQ(1.0f, value);
+
+  ASSERT_TRUE(calibration.Apply(128, value));
+  EXPECT_NEAR(0.0f, value, 0.01f);
+}
+
+TEST(TestAxisCalibration, TriggerRestsAtMinimum)
+{
+  CAxisCalibration calibration;
+  calibration.Calibrate(0, 255, 0, 0, true);
+
+  float value;
+
+  ASSERT_TRUE(calibration.Apply(0, value));
+  EXPECT_FLOAT_EQ(0.0f, value);
+
+  ASSERT_TRUE(calibration.Apply(255, value));
+  EXPECT_FLOAT_EQ(1.0f, value);
+}
+
+TEST(TestAxisCalibration, FlatZone)
+{
+  CAxisCalibration calibration;
+  calibration.Calibrate(-100, 100, 10, 0, false);
+
+  float value;
+
+  ASSERT_TRUE(calibration.Apply(10, value));
+  EXPECT_FLOAT_EQ(0.0f, value);
+
+  // The remaining range is rescaled, so the output stays continuous
+  ASSERT_TRUE(calibration.Apply(55, value));
+  EXPECT_FLOAT_EQ(0.5f, value);
+
+  ASSERT_TRUE(calibration.Apply(-100, value));
+  EXPECT_FLOAT_EQ(-1.0f, value);
+}
+
+TEST(TestAxisCalibration, FuzzDropsNoise)
+{
+  CAxisCalibration calibration;
+  calibration.Calibrate(-100, 100, 0, 8, false);
+
+  float value;
+
+  ASSERT_TRUE(calibration.Apply(50, value));
+
+  // Less than half of the fuzz away from the last value
+  EXPECT_FALSE(calibration.Apply(53, value));
+
+  EXPECT_TRUE(calibration.Apply(54, value));
+  EXPECT_FLOAT_EQ(0.54f, value);
+}
+
+TEST(TestAxisCalibration, UnchangedValueIsDropped)
+{
+  CAxisCalibration calibration;
+  calibration.Calibrate(-100, 100, 20, 0, false);
+
+  float value;
+
+  ASSERT_TRUE(calibration.Apply(5, value));
+
+  // Still within the flat zone
+  EXPECT_FALSE(calibration.Apply(-5, value));
+
+  // Recalibrating reports the next value again
+  calibration.Calibrate(-100, 100, 20, 0, false);
+  EXPECT_TRUE(calibration.Apply(-5, value));
+}
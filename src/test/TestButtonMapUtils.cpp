@@ -0,0 +1,110 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "buttonmapper/ButtonMapUtils.h"
+
+#include <kodi/addon-instance/PeripheralUtils.h>
+
+#include <gtest/gtest.h>
+
+using namespace JOYSTICK;
+
+namespace
+{
+  kodi::addon::DriverPrimitive SemiAxis(unsigned int axisIndex, JOYSTICK_DRIVER_SEMIAXIS_DIRECTION direction)
+  {
+    return kodi::addon::DriverPrimitive(axisIndex, 0, direction, 1);
+  }
+}
+
+TEST(TestButtonMapUtils, LegacyHatAxesBecomeHats)
+{
+  // Six axes, followed by the X and Y axes of two hats
+  const LegacyAxisLayout layout = ButtonMapUtils::GetLegacyAxisLayout(6, 2);
+
+  kodi::addon::JoystickFeature dpad("up", JOYSTICK_FEATURE_TYPE_ANALOG_STICK);
+  dpad.SetPrimitive(JOYSTICK_ANALOG_STICK_UP, SemiAxis(7, JOYSTICK_DRIVER_SEMIAXIS_NEGATIVE));
+  dpad.SetPrimitive(JOYSTICK_ANALOG_STICK_DOWN, SemiAxis(7, JOYSTICK_DRIVER_SEMIAXIS_POSITIVE));
+  dpad.SetPrimitive(JOYSTICK_ANALOG_STICK_RIGHT, SemiAxis(8, JOYSTICK_DRIVER_SEMIAXIS_POSITIVE));
+  dpad.SetPrimitive(JOYSTICK_ANALOG_STICK_LEFT, SemiAxis(8, JOYSTICK_DRIVER_SEMIAXIS_NEGATIVE));
+
+  EXPECT_TRUE(ButtonMapUtils::ConvertLegacyHatAxes(dpad, layout));
+
+  EXPECT_EQ(kodi::addon::DriverPrimitive(0, JOYSTICK_DRIVER_HAT_UP), dpad.Primitive(JOYSTICK_ANALOG_STICK_UP));
+  EXPECT_EQ(kodi::addon::DriverPrimitive(0, JOYSTICK_DRIVER_HAT_DOWN), dpad.Primitive(JOYSTICK_ANALOG_STICK_DOWN));
+  EXPECT_EQ(kodi::addon::DriverPrimitive(1, JOYSTICK_DRIVER_HAT_RIGHT), dpad.Primitive(JOYSTICK_ANALOG_STICK_RIGHT));
+  EXPECT_EQ(kodi::addon::DriverPrimitive(1, JOYSTICK_DRIVER_HAT_LEFT), dpad.Primitive(JOYSTICK_ANALOG_STICK_LEFT));
+}
+
+TEST(TestButtonMapUtils, RegularAxesAreKept)
+{
+  kodi::addon::JoystickFeature stick("leftstick", JOYSTICK_FEATURE_TYPE_ANALOG_STICK);
+  stick.SetPrimitive(JOYSTICK_ANALOG_STICK_UP, SemiAxis(1, JOYSTICK_DRIVER_SEMIAXIS_NEGATIVE));
+  stick.SetPrimitive(JOYSTICK_ANALOG_STICK_RIGHT, SemiAxis(0, JOYSTICK_DRIVER_SEMIAXIS_POSITIVE));
+
+  kodi::addon::JoystickFeature button("a", JOYSTICK_FEATURE_TYPE_SCALAR);
+  button.SetPrimitive(JOYSTICK_SCALAR_PRIMITIVE, kodi::addon::DriverPrimitive::CreateButton(7));
+
+  const kodi::addon::JoystickFeature stickBefore = stick;
+  const kodi::addon::JoystickFeature buttonBefore = button;
+
+  const LegacyAxisLayout layout = ButtonMapUtils::GetLegacyAxisLayout(2, 1);
+
+  EXPECT_FALSE(ButtonMapUtils::ConvertLegacyHatAxes(stick, layout));
+  EXPECT_FALSE(ButtonMapUtils::ConvertLegacyHatAxes(button, layout));
+
+  EXPECT_EQ(stickBefore.Primitive(JOYSTICK_ANALOG_STICK_UP), stick.Primitive(JOYSTICK_ANALOG_STICK_UP));
+  EXPECT_EQ(stickBefore.Primitive(JOYSTICK_ANALOG_STICK_RIGHT), stick.Primitive(JOYSTICK_ANALOG_STICK_RIGHT));
+  EXPECT_EQ(buttonBefore.Primitive(JOYSTICK_SCALAR_PRIMITIVE), button.Primitive(JOYSTICK_SCALAR_PRIMITIVE));
+}
+
+TEST(TestButtonMapUtils, LegacyHatBetweenAxes)
+{
+  // ABS_X, ABS_Y, ABS_HAT0X, ABS_HAT0Y and ABS_PRESSURE, numbered in code
+  // order like udev used to
+  const LegacyAxisLayout layout = {
+    { false, 0, false },
+    { false, 1, false },
+    { true, 0, false },
+    { true, 0, true },
+    { false, 2, false },
+  };
+
+  kodi::addon::JoystickFeature dpad("up", JOYSTICK_FEATURE_TYPE_ANALOG_STICK);
+  dpad.SetPrimitive(JOYSTICK_ANALOG_STICK_UP, SemiAxis(3, JOYSTICK_DRIVER_SEMIAXIS_NEGATIVE));
+  dpad.SetPrimitive(JOYSTICK_ANALOG_STICK_LEFT, SemiAxis(2, JOYSTICK_DRIVER_SEMIAXIS_NEGATIVE));
+
+  kodi::addon::JoystickFeature stick("leftstick", JOYSTICK_FEATURE_TYPE_ANALOG_STICK);
+  stick.SetPrimitive(JOYSTICK_ANALOG_STICK_RIGHT, SemiAxis(0, JOYSTICK_DRIVER_SEMIAXIS_POSITIVE));
+
+  kodi::addon::JoystickFeature trigger("lefttrigger", JOYSTICK_FEATURE_TYPE_SCALAR);
+  trigger.SetPrimitive(JOYSTICK_SCALAR_PRIMITIVE, kodi::addon::DriverPrimitive(4, -1, JOYSTICK_DRIVER_SEMIAXIS_POSITIVE, 2));
+
+  EXPECT_TRUE(ButtonMapUtils::ConvertLegacyHatAxes(dpad, layout));
+  EXPECT_FALSE(ButtonMapUtils::ConvertLegacyHatAxes(stick, layout));
+  EXPECT_TRUE(ButtonMapUtils::ConvertLegacyHatAxes(trigger, layout));
+
+  EXPECT_EQ(kodi::addon::DriverPrimitive(0, JOYSTICK_DRIVER_HAT_UP), dpad.Primitive(JOYSTICK_ANALOG_STICK_UP));
+  EXPECT_EQ(kodi::addon::DriverPrimitive(0, JOYSTICK_DRIVER_HAT_LEFT), dpad.Primitive(JOYSTICK_ANALOG_STICK_LEFT));
+  EXPECT_EQ(SemiAxis(0, JOYSTICK_DRIVER_SEMIAXIS_POSITIVE), stick.Primitive(JOYSTICK_ANALOG_STICK_RIGHT));
+
+  // The axis after the hat moves down, keeping its center and range
+  EXPECT_EQ(kodi::addon::DriverPrimitive(2, -1, JOYSTICK_DRIVER_SEMIAXIS_POSITIVE, 2), trigger.Primitive(JOYSTICK_SCALAR_PRIMITIVE));
+}
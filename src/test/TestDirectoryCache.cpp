@@ -0,0 +1,100 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "filesystem/DirectoryCache.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+using namespace JOYSTICK;
+
+namespace
+{
+  class CCountingCallback : public IDirectoryCacheCallback
+  {
+  public:
+    virtual void OnAdd(const kodi::vfs::CDirEntry& item) override { added++; }
+    virtual void OnRemove(const kodi::vfs::CDirEntry& item) override { removed++; }
+
+    unsigned int added = 0;
+    unsigned int removed = 0;
+  };
+}
+
+TEST(TestDirectoryCache, UnknownPathIsNotFresh)
+{
+  CCountingCallback callback;
+  CDirectoryCache cache;
+  cache.Initialize(&callback);
+
+  std::vector<kodi::vfs::CDirEntry> items;
+  EXPECT_FALSE(cache.IsFresh("/buttonmaps"));
+  EXPECT_FALSE(cache.GetDirectory("/buttonmaps", items));
+}
+
+TEST(TestDirectoryCache, UpdateReportsChanges)
+{
+  CCountingCallback callback;
+  CDirectoryCache cache;
+  cache.Initialize(&callback);
+
+  cache.UpdateDirectory("/buttonmaps", {
+    kodi::vfs::CDirEntry("a.xml", "/buttonmaps/a.xml"),
+    kodi::vfs::CDirEntry("b.xml", "/buttonmaps/b.xml"),
+  });
+  EXPECT_EQ(2u, callback.added);
+  EXPECT_EQ(0u, callback.removed);
+
+  cache.UpdateDirectory("/buttonmaps", {
+    kodi::vfs::CDirEntry("b.xml", "/buttonmaps/b.xml"),
+    kodi::vfs::CDirEntry("c.xml", "/buttonmaps/c.xml"),
+  });
+  EXPECT_EQ(3u, callback.added);
+  EXPECT_EQ(1u, callback.removed);
+
+  std::vector<kodi::vfs::CDirEntry> items;
+  ASSERT_TRUE(cache.GetDirectory("/buttonmaps", items));
+  ASSERT_EQ(2u, items.size());
+  EXPECT_EQ("/buttonmaps/c.xml", items[1].Path());
+}
+
+TEST(TestDirectoryCache, FreshnessExpires)
+{
+  CCountingCallback callback;
+  CDirectoryCache cache;
+  cache.Initialize(&callback);
+
+  cache.UpdateDirectory("/buttonmaps", { kodi::vfs::CDirEntry("a.xml", "/buttonmaps/a.xml") });
+  EXPECT_TRUE(cache.IsFresh("/buttonmaps"));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(DIRECTORY_LIFETIME_MS + 100));
+
+  EXPECT_FALSE(cache.IsFresh("/buttonmaps"));
+
+  std::vector<kodi::vfs::CDirEntry> items;
+  EXPECT_FALSE(cache.GetDirectory("/buttonmaps", items));
+
+  // Updating makes the listing fresh again
+  cache.UpdateDirectory("/buttonmaps", { kodi::vfs::CDirEntry("a.xml", "/buttonmaps/a.xml") });
+  EXPECT_TRUE(cache.IsFresh("/buttonmaps"));
+  EXPECT_EQ(1u, callback.added);
+}
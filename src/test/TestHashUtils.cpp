@@ -0,0 +1,67 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/HashUtils.h"
+
+#include <gtest/gtest.h>
+
+using namespace JOYSTICK;
+
+TEST(TestHashUtils, KnownValues)
+{
+  // Test vectors of 64-bit FNV-1a
+  uint64_t hash = HashUtils::OFFSET_BASIS;
+  HashUtils::HashBytes(hash, "", 0);
+  EXPECT_EQ(0xcbf29ce484222325ULL, hash);
+
+  hash = HashUtils::OFFSET_BASIS;
+  HashUtils::HashBytes(hash, "a", 1);
+  EXPECT_EQ(0xaf63dc4c8601ec8cULL, hash);
+
+  hash = HashUtils::OFFSET_BASIS;
+  HashUtils::HashBytes(hash, "foobar", 6);
+  EXPECT_EQ(0x85944171f73967e8ULL, hash);
+}
+
+TEST(TestHashUtils, StringBoundaries)
+{
+  uint64_t lhs = HashUtils::OFFSET_BASIS;
+  HashUtils::HashString(lhs, "ab");
+  HashUtils::HashString(lhs, "c");
+
+  uint64_t rhs = HashUtils::OFFSET_BASIS;
+  HashUtils::HashString(rhs, "a");
+  HashUtils::HashString(rhs, "bc");
+
+  EXPECT_NE(lhs, rhs);
+}
+
+TEST(TestHashUtils, Values)
+{
+  uint64_t lhs = HashUtils::OFFSET_BASIS;
+  HashUtils::HashValue<uint16_t>(lhs, 0x045e);
+  HashUtils::HashValue<uint16_t>(lhs, 0x028e);
+
+  uint64_t rhs = HashUtils::OFFSET_BASIS;
+  HashUtils::HashValue<uint16_t>(rhs, 0x028e);
+  HashUtils::HashValue<uint16_t>(rhs, 0x045e);
+
+  EXPECT_NE(lhs, rhs);
+}
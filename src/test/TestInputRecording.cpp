@@ -0,0 +1,199 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "api/replay/InputRecording.h"
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string>
+
+using namespace JOYSTICK;
+
+namespace
+{
+  class TestInputRecording : public ::testing::Test
+  {
+  protected:
+    void SetUp(void) override
+    {
+      m_path = ::testing::TempDir() + "joystick-recording.bin";
+    }
+
+    void TearDown(void) override
+    {
+      remove(m_path.c_str());
+    }
+
+    template<typename T>
+    static void Write(FILE* file, T value)
+    {
+      ASSERT_EQ(1u, fwrite(&value, sizeof(value), 1, file));
+    }
+
+    static void WriteString(FILE* file, const std::string& str)
+    {
+      Write<uint16_t>(file, static_cast<uint16_t>(str.size()));
+      ASSERT_EQ(str.size(), fwrite(str.c_str(), 1, str.size(), file));
+    }
+
+    /*!
+     * \brief Write the start of a header by hand, up to the button bindings
+     */
+    static void WriteHeaderStart(FILE* file, uint16_t version)
+    {
+      const char magic[8] = "KJOYREC";
+      ASSERT_EQ(1u, fwrite(magic, sizeof(magic), 1, file));
+
+      Write<uint16_t>(file, version);
+      Write<uint16_t>(file, 0); // EVDEV
+      WriteString(file, "Pad");
+      WriteString(file, "udev");
+      Write<uint16_t>(file, 0x045e);
+      Write<uint16_t>(file, 0x028e);
+      Write<uint32_t>(file, 0); // Buttons
+      Write<uint32_t>(file, 0); // Hats
+      Write<uint32_t>(file, 1); // Axes
+      Write<uint32_t>(file, 0); // Button bindings
+    }
+
+    std::string m_path;
+  };
+}
+
+TEST_F(TestInputRecording, RoundTrip)
+{
+  InputRecordingHeader header;
+  header.format = EInputRecordingFormat::EVDEV;
+  header.name = "Xbox 360 Controller";
+  header.provider = "udev";
+  header.vendorId = 0x045e;
+  header.productId = 0x028e;
+  header.buttonCount = 11;
+  header.hatCount = 1;
+  header.axisCount = 6;
+  header.buttons.push_back({ 0x130, 0 });
+  header.buttons.push_back({ 0x131, 1 });
+  header.axes.push_back({ 0x00, 0, -32768, 32767, 128, 16 });
+  header.axes.push_back({ 0x10, 0, -1, 1, 0, 0 });
+
+  FILE* file = fopen(m_path.c_str(), "wb");
+  ASSERT_NE(nullptr, file);
+  ASSERT_TRUE(CInputRecording::WriteHeader(file, header));
+  ASSERT_TRUE(CInputRecording::WriteEvent(file, { 0, 3, 0x00, -1234 }));
+  ASSERT_TRUE(CInputRecording::WriteEvent(file, { 8000, 1, 0x130, 1 }));
+  fclose(file);
+
+  CInputRecording recording;
+  ASSERT_TRUE(recording.Load(m_path));
+
+  const InputRecordingHeader& loaded = recording.Header();
+  EXPECT_EQ(EInputRecordingFormat::EVDEV, loaded.format);
+  EXPECT_EQ(header.name, loaded.name);
+  EXPECT_EQ(header.provider, loaded.provider);
+  EXPECT_EQ(header.vendorId, loaded.vendorId);
+  EXPECT_EQ(header.productId, loaded.productId);
+  EXPECT_EQ(header.buttonCount, loaded.buttonCount);
+  EXPECT_EQ(header.hatCount, loaded.hatCount);
+  EXPECT_EQ(header.axisCount, loaded.axisCount);
+
+  ASSERT_EQ(2u, loaded.buttons.size());
+  EXPECT_EQ(0x131, loaded.buttons[1].code);
+  EXPECT_EQ(1, loaded.buttons[1].buttonIndex);
+
+  ASSERT_EQ(2u, loaded.axes.size());
+  EXPECT_EQ(-32768, loaded.axes[0].minimum);
+  EXPECT_EQ(32767, loaded.axes[0].maximum);
+  EXPECT_EQ(128, loaded.axes[0].flat);
+  EXPECT_EQ(16, loaded.axes[0].fuzz);
+
+  ASSERT_EQ(2u, recording.Events().size());
+  EXPECT_EQ(0u, recording.Events()[0].deltaUs);
+  EXPECT_EQ(-1234, recording.Events()[0].value);
+  EXPECT_EQ(8000u, recording.Events()[1].deltaUs);
+  EXPECT_EQ(0x130, recording.Events()[1].code);
+}
+
+TEST_F(TestInputRecording, PartialEventIsIgnored)
+{
+  InputRecordingHeader header;
+
+  FILE* file = fopen(m_path.c_str(), "wb");
+  ASSERT_NE(nullptr, file);
+  ASSERT_TRUE(CInputRecording::WriteHeader(file, header));
+  ASSERT_TRUE(CInputRecording::WriteEvent(file, { 0, 1, 0x130, 1 }));
+  Write<uint32_t>(file, 1000); // Recording cut off during the next event
+  fclose(file);
+
+  CInputRecording recording;
+  ASSERT_TRUE(recording.Load(m_path));
+  EXPECT_EQ(1u, recording.Events().size());
+}
+
+TEST_F(TestInputRecording, Version1HasNoFlatOrFuzz)
+{
+  FILE* file = fopen(m_path.c_str(), "wb");
+  ASSERT_NE(nullptr, file);
+  WriteHeaderStart(file, 1);
+  Write<uint32_t>(file, 1);   // Axis bindings
+  Write<uint16_t>(file, 0x01);
+  Write<uint16_t>(file, 0);
+  Write<int32_t>(file, 0);
+  Write<int32_t>(file, 255);
+  fclose(file);
+
+  CInputRecording recording;
+  ASSERT_TRUE(recording.Load(m_path));
+
+  ASSERT_EQ(1u, recording.Header().axes.size());
+  EXPECT_EQ(0x01, recording.Header().axes[0].code);
+  EXPECT_EQ(255, recording.Header().axes[0].maximum);
+  EXPECT_EQ(0, recording.Header().axes[0].flat);
+  EXPECT_EQ(0, recording.Header().axes[0].fuzz);
+  EXPECT_TRUE(recording.Events().empty());
+}
+
+TEST_F(TestInputRecording, FutureVersionIsRejected)
+{
+  FILE* file = fopen(m_path.c_str(), "wb");
+  ASSERT_NE(nullptr, file);
+  WriteHeaderStart(file, 0xffff);
+  Write<uint32_t>(file, 0);
+  fclose(file);
+
+  CInputRecording recording;
+  EXPECT_FALSE(recording.Load(m_path));
+}
+
+TEST_F(TestInputRecording, BadMagicIsRejected)
+{
+  FILE* file = fopen(m_path.c_str(), "wb");
+  ASSERT_NE(nullptr, file);
+  fputs("not a recording", file);
+  fclose(file);
+
+  CInputRecording recording;
+  EXPECT_FALSE(recording.Load(m_path));
+}
+
+TEST_F(TestInputRecording, MissingFile)
+{
+  CInputRecording recording;
+  EXPECT_FALSE(recording.Load(m_path));
+}
@@ -0,0 +1,243 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "api/udev/JoystickMonitorUdev.h"
+
+#include <gtest/gtest.h>
+
+#include <deque>
+#include <libudev.h>
+#include <map>
+#include <string>
+#include <unistd.h>
+
+using namespace JOYSTICK;
+
+// --- Fake libudev ------------------------------------------------------------
+
+// The monitor's fd is a pipe with one byte per queued event, so it can be
+// polled like the netlink socket.
+
+struct udev_device
+{
+  std::string                        action;
+  std::string                        devnode;
+  std::map<std::string, std::string> properties;
+};
+
+struct udev_monitor
+{
+  int                      fds[2];
+  std::deque<udev_device*> events;
+};
+
+namespace
+{
+  bool bMonitorAvailable = true;
+  udev_monitor* fakeMonitor = nullptr;
+
+  void QueueEvent(const std::string& action, const std::string& devnode, const std::string& property)
+  {
+    udev_device* dev = new udev_device;
+    dev->action = action;
+    dev->devnode = devnode;
+    dev->properties[property] = "1";
+
+    fakeMonitor->events.push_back(dev);
+    ASSERT_EQ(1, write(fakeMonitor->fds[1], "e", 1));
+  }
+
+  size_t QueuedEvents(void)
+  {
+    return fakeMonitor->events.size();
+  }
+}
+
+extern "C"
+{
+  udev_monitor* udev_monitor_new_from_netlink(udev* udev, const char* name)
+  {
+    if (!bMonitorAvailable)
+      return nullptr;
+
+    fakeMonitor = new udev_monitor;
+    if (pipe(fakeMonitor->fds) != 0)
+      return nullptr;
+
+    return fakeMonitor;
+  }
+
+  int udev_monitor_filter_add_match_subsystem_devtype(udev_monitor* udev_monitor, const char* subsystem, const char* devtype)
+  {
+    return 0;
+  }
+
+  int udev_monitor_enable_receiving(udev_monitor* udev_monitor)
+  {
+    return 0;
+  }
+
+  udev_monitor* udev_monitor_unref(udev_monitor* udev_monitor)
+  {
+    for (udev_device* dev : udev_monitor->events)
+      delete dev;
+
+    close(udev_monitor->fds[0]);
+    close(udev_monitor->fds[1]);
+    delete udev_monitor;
+
+    if (fakeMonitor == udev_monitor)
+      fakeMonitor = nullptr;
+
+    return nullptr;
+  }
+
+  int udev_monitor_get_fd(udev_monitor* udev_monitor)
+  {
+    return udev_monitor->fds[0];
+  }
+
+  udev_device* udev_monitor_receive_device(udev_monitor* udev_monitor)
+  {
+    if (udev_monitor->events.empty())
+      return nullptr;
+
+    char byte;
+    if (read(udev_monitor->fds[0], &byte, 1) != 1)
+      return nullptr;
+
+    udev_device* dev = udev_monitor->events.front();
+    udev_monitor->events.pop_front();
+    return dev;
+  }
+
+  const char* udev_device_get_action(udev_device* udev_device)
+  {
+    return udev_device->action.c_str();
+  }
+
+  const char* udev_device_get_devnode(udev_device* udev_device)
+  {
+    return udev_device->devnode.empty() ? nullptr : udev_device->devnode.c_str();
+  }
+
+  const char* udev_device_get_property_value(udev_device* udev_device, const char* key)
+  {
+    auto it = udev_device->properties.find(key);
+    if (it == udev_device->properties.end())
+      return nullptr;
+
+    return it->second.c_str();
+  }
+
+  udev_device* udev_device_unref(udev_device* udev_device)
+  {
+    delete udev_device;
+    return nullptr;
+  }
+}
+
+// --- Tests -------------------------------------------------------------------
+
+namespace
+{
+  class TestJoystickMonitorUdev : public ::testing::Test
+  {
+  protected:
+    void SetUp(void) override
+    {
+      bMonitorAvailable = true;
+      ASSERT_TRUE(m_monitor.Initialize(nullptr));
+    }
+
+    CJoystickMonitorUdev m_monitor;
+  };
+}
+
+TEST_F(TestJoystickMonitorUdev, UnchangedScanSkipsProbing)
+{
+  // Nothing has been enumerated yet
+  EXPECT_TRUE(m_monitor.HasChanges());
+
+  m_monitor.ScanCompleted();
+
+  // No hotplug, so the interface doesn't need to be probed again
+  EXPECT_FALSE(m_monitor.HasChanges());
+  EXPECT_FALSE(m_monitor.HasChanges());
+}
+
+TEST_F(TestJoystickMonitorUdev, JoystickAdded)
+{
+  m_monitor.ScanCompleted();
+
+  QueueEvent("add", "/dev/input/event5", "ID_INPUT_JOYSTICK");
+
+  EXPECT_TRUE(m_monitor.HasChanges());
+  EXPECT_EQ(0u, QueuedEvents());
+
+  // Changed until the joysticks are enumerated
+  EXPECT_TRUE(m_monitor.HasChanges());
+
+  m_monitor.ScanCompleted();
+  EXPECT_FALSE(m_monitor.HasChanges());
+}
+
+TEST_F(TestJoystickMonitorUdev, JoystickRemoved)
+{
+  m_monitor.ScanCompleted();
+
+  QueueEvent("remove", "/dev/input/event5", "ID_INPUT_JOYSTICK");
+
+  EXPECT_TRUE(m_monitor.HasChanges());
+}
+
+TEST_F(TestJoystickMonitorUdev, OtherDevicesAreDrained)
+{
+  m_monitor.ScanCompleted();
+
+  QueueEvent("add", "/dev/input/event6", "ID_INPUT_KEYBOARD");
+  QueueEvent("add", "/dev/input/event7", "ID_INPUT_MOUSE");
+
+  EXPECT_FALSE(m_monitor.HasChanges());
+  EXPECT_EQ(0u, QueuedEvents());
+}
+
+TEST_F(TestJoystickMonitorUdev, ParentDeviceIsIgnored)
+{
+  m_monitor.ScanCompleted();
+
+  // The inputN parent has the joystick property, but no device node
+  QueueEvent("add", "", "ID_INPUT_JOYSTICK");
+
+  EXPECT_FALSE(m_monitor.HasChanges());
+}
+
+TEST(TestJoystickMonitorUdevUnavailable, AlwaysChanged)
+{
+  bMonitorAvailable = false;
+
+  CJoystickMonitorUdev monitor;
+  EXPECT_FALSE(monitor.Initialize(nullptr));
+
+  monitor.ScanCompleted();
+  EXPECT_TRUE(monitor.HasChanges());
+
+  bMonitorAvailable = true;
+}
@@ -0,0 +1,137 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "api/JoystickStateStore.h"
+
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace JOYSTICK;
+
+TEST(TestJoystickStateStore, ButtonsAreReportedOnChange)
+{
+  CJoystickStateStore store;
+  const int slot = store.Allocate(40, 0, 0);
+
+  // Button 33 lives in the second word of the slice
+  store.SetButton(slot, 33, JOYSTICK_STATE_BUTTON_PRESSED);
+  store.Stage(slot, 7);
+
+  std::vector<kodi::addon::PeripheralEvent> events;
+  EXPECT_TRUE(store.GetEvents(events));
+  ASSERT_EQ(1u, events.size());
+  EXPECT_EQ(PERIPHERAL_EVENT_TYPE_DRIVER_BUTTON, events[0].Type());
+  EXPECT_EQ(7u, events[0].PeripheralIndex());
+  EXPECT_EQ(33u, events[0].DriverIndex());
+  EXPECT_EQ(JOYSTICK_STATE_BUTTON_PRESSED, events[0].ButtonState());
+
+  // Nothing changed since the last poll
+  events.clear();
+  store.Stage(slot, 7);
+  EXPECT_FALSE(store.GetEvents(events));
+  EXPECT_TRUE(events.empty());
+}
+
+TEST(TestJoystickStateStore, UnstagedSlicesAreSkipped)
+{
+  CJoystickStateStore store;
+  const int slot = store.Allocate(1, 1, 0);
+
+  store.SetButton(slot, 0, JOYSTICK_STATE_BUTTON_PRESSED);
+  store.SetHat(slot, 0, JOYSTICK_STATE_HAT_UP);
+
+  std::vector<kodi::addon::PeripheralEvent> events;
+  EXPECT_FALSE(store.GetEvents(events));
+  EXPECT_TRUE(events.empty());
+
+  store.Stage(slot, 0);
+  EXPECT_TRUE(store.GetEvents(events));
+  EXPECT_EQ(2u, events.size());
+}
+
+TEST(TestJoystickStateStore, AxesAreReportedOnceSeen)
+{
+  CJoystickStateStore store;
+  const int slot = store.Allocate(0, 0, 3);
+
+  store.SetAxis(slot, 2, 0.5f);
+  store.Stage(slot, 0);
+
+  std::vector<kodi::addon::PeripheralEvent> events;
+  EXPECT_TRUE(store.GetEvents(events));
+  ASSERT_EQ(1u, events.size());
+  EXPECT_EQ(PERIPHERAL_EVENT_TYPE_DRIVER_AXIS, events[0].Type());
+  EXPECT_EQ(2u, events[0].DriverIndex());
+  EXPECT_FLOAT_EQ(0.5f, events[0].AxisState());
+
+  // Still reported, but not as a change
+  events.clear();
+  store.Stage(slot, 0);
+  EXPECT_FALSE(store.GetEvents(events));
+  EXPECT_EQ(1u, events.size());
+}
+
+TEST(TestJoystickStateStore, ReleaseCompactsSlices)
+{
+  CJoystickStateStore store;
+  const int first = store.Allocate(33, 2, 5);
+  const int second = store.Allocate(3, 1, 2);
+
+  store.SetButton(second, 2, JOYSTICK_STATE_BUTTON_PRESSED);
+  store.SetHat(second, 0, JOYSTICK_STATE_HAT_LEFT);
+  store.SetAxis(second, 1, -0.25f);
+  store.Stage(second, 1);
+
+  std::vector<kodi::addon::PeripheralEvent> events;
+  store.GetEvents(events);
+
+  // The second slice moves into the space of the first
+  store.Release(first);
+
+  uint32_t buttons[1] = { };
+  uint8_t hats[1] = { };
+  float axes[2] = { };
+  ASSERT_TRUE(store.ReadState(second, buttons, hats, axes));
+  EXPECT_EQ(1u << 2, buttons[0]);
+  EXPECT_EQ(JOYSTICK_STATE_HAT_LEFT, hats[0]);
+  EXPECT_FLOAT_EQ(0.0f, axes[0]);
+  EXPECT_FLOAT_EQ(-0.25f, axes[1]);
+
+  EXPECT_FALSE(store.ReadState(first, buttons, hats, axes));
+
+  // Released slots are reused
+  EXPECT_EQ(first, store.Allocate(1, 0, 0));
+}
+
+TEST(TestJoystickStateStore, InvalidIndicesAreIgnored)
+{
+  CJoystickStateStore store;
+  const int slot = store.Allocate(2, 1, 1);
+
+  store.SetButton(slot, 2, JOYSTICK_STATE_BUTTON_PRESSED);
+  store.SetHat(slot, 1, JOYSTICK_STATE_HAT_UP);
+  store.SetAxis(slot, 1, 1.0f);
+  store.SetButton(slot + 1, 0, JOYSTICK_STATE_BUTTON_PRESSED);
+  store.Stage(slot, 0);
+
+  std::vector<kodi::addon::PeripheralEvent> events;
+  EXPECT_FALSE(store.GetEvents(events));
+  EXPECT_TRUE(events.empty());
+}
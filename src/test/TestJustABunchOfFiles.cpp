@@ -0,0 +1,225 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "storage/ButtonMap.h"
+#include "storage/Device.h"
+#include "storage/JustABunchOfFiles.h"
+
+#include <kodi/addon-instance/PeripheralUtils.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace JOYSTICK;
+
+#define CONTROLLER_ID  "game.controller.default"
+
+namespace
+{
+  /*!
+   * \brief Button map that is "saved" in memory
+   */
+  class CMemoryButtonMap : public CButtonMap
+  {
+  public:
+    CMemoryButtonMap(const std::string& strResourcePath) :
+      CButtonMap(strResourcePath, nullptr)
+    {
+    }
+
+    CMemoryButtonMap(const std::string& strResourcePath, const DevicePtr& device) :
+      CButtonMap(strResourcePath, device, nullptr)
+    {
+    }
+
+    virtual bool LoadDevice(void) override { return true; }
+
+  protected:
+    virtual bool Load(void) override
+    {
+      m_buttonMap = m_savedButtonMap;
+      return true;
+    }
+
+    virtual bool Save(void) const override
+    {
+      m_savedButtonMap = m_buttonMap;
+      return true;
+    }
+
+  private:
+    mutable ButtonMap m_savedButtonMap;
+  };
+
+  class CMemoryDatabase : public CJustABunchOfFiles
+  {
+  public:
+    CMemoryDatabase(IDatabaseCallbacks* callbacks) :
+      CJustABunchOfFiles("memory://buttonmaps", ".xml", true, callbacks)
+    {
+    }
+
+    virtual CButtonMap* CreateResource(const std::string& resourcePath) const override
+    {
+      return new CMemoryButtonMap(resourcePath);
+    }
+
+    virtual CButtonMap* CreateResource(const std::string& resourcePath, const DevicePtr& driverInfo) const override
+    {
+      return new CMemoryButtonMap(resourcePath, driverInfo);
+    }
+  };
+
+  class CDatabaseCallbacks : public IDatabaseCallbacks
+  {
+  public:
+    virtual void OnAdd(const DevicePtr& driverInfo, const ButtonMap& buttonMap) override
+    {
+      added++;
+    }
+
+    virtual DevicePtr CreateDevice(const CDevice& deviceInfo) override
+    {
+      return std::make_shared<CDevice>(deviceInfo);
+    }
+
+    std::atomic<unsigned int> added{0};
+  };
+
+  kodi::addon::Joystick CreateJoystick(unsigned int index)
+  {
+    kodi::addon::Joystick joystick("udev", "Pad " + std::to_string(index));
+    joystick.SetButtonCount(12);
+    joystick.SetAxisCount(4);
+    return joystick;
+  }
+
+  FeatureVector CreateFeatures(unsigned int buttonIndex)
+  {
+    kodi::addon::JoystickFeature feature("a", JOYSTICK_FEATURE_TYPE_SCALAR);
+    feature.SetPrimitive(JOYSTICK_SCALAR_PRIMITIVE, kodi::addon::DriverPrimitive::CreateButton(buttonIndex));
+    return FeatureVector{ feature };
+  }
+
+  bool HasButton(const ButtonMap& buttonMap, unsigned int buttonIndex)
+  {
+    auto it = buttonMap.find(CONTROLLER_ID);
+    if (it == buttonMap.end())
+      return false;
+
+    return std::find_if(it->second.begin(), it->second.end(),
+      [buttonIndex](const kodi::addon::JoystickFeature& feature)
+      {
+        const kodi::addon::DriverPrimitive& primitive = feature.Primitive(JOYSTICK_SCALAR_PRIMITIVE);
+        return primitive.Type() == JOYSTICK_DRIVER_PRIMITIVE_TYPE_BUTTON &&
+               primitive.DriverIndex() == buttonIndex;
+      }) != it->second.end();
+  }
+}
+
+TEST(TestJustABunchOfFiles, MapSaveAndRevert)
+{
+  CDatabaseCallbacks callbacks;
+  CMemoryDatabase database(&callbacks);
+
+  const kodi::addon::Joystick joystick = CreateJoystick(0);
+
+  EXPECT_TRUE(database.GetButtonMap(joystick).empty());
+
+  ASSERT_TRUE(database.MapFeatures(joystick, CONTROLLER_ID, CreateFeatures(1)));
+  ASSERT_TRUE(database.SaveButtonMap(joystick));
+  EXPECT_TRUE(HasButton(database.GetButtonMap(joystick), 1));
+
+  ASSERT_TRUE(database.MapFeatures(joystick, CONTROLLER_ID, CreateFeatures(2)));
+  EXPECT_TRUE(HasButton(database.GetButtonMap(joystick), 2));
+
+  ASSERT_TRUE(database.RevertButtonMap(joystick));
+  EXPECT_TRUE(HasButton(database.GetButtonMap(joystick), 1));
+}
+
+/*!
+ * \brief Look up, map, save and revert button maps from many threads at once
+ *
+ * Build with ENABLE_TSAN to check the storage locks with ThreadSanitizer.
+ */
+TEST(TestJustABunchOfFiles, ConcurrentAccess)
+{
+  const unsigned int THREAD_COUNT = 8;
+  const unsigned int JOYSTICK_COUNT = 6;
+  const unsigned int ITERATIONS = 2000;
+
+  CDatabaseCallbacks callbacks;
+  CMemoryDatabase database(&callbacks);
+
+  std::vector<kodi::addon::Joystick> joysticks;
+  for (unsigned int i = 0; i < JOYSTICK_COUNT; i++)
+    joysticks.push_back(CreateJoystick(i));
+
+  std::atomic<unsigned int> failures{0};
+
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < THREAD_COUNT; t++)
+  {
+    threads.emplace_back([&, t]()
+    {
+      for (unsigned int i = 0; i < ITERATIONS; i++)
+      {
+        const kodi::addon::Joystick& joystick = joysticks[(i * 7 + t) % JOYSTICK_COUNT];
+
+        switch ((i + t) % 4)
+        {
+        case 0:
+          database.GetButtonMap(joystick);
+          break;
+        case 1:
+          if (!database.MapFeatures(joystick, CONTROLLER_ID, CreateFeatures(t)))
+            failures++;
+          break;
+        case 2:
+          database.SaveButtonMap(joystick);
+          break;
+        case 3:
+          database.RevertButtonMap(joystick);
+          break;
+        default:
+          break;
+        }
+      }
+    });
+  }
+
+  for (std::thread& thread : threads)
+    thread.join();
+
+  EXPECT_EQ(0u, failures);
+
+  // Every joystick still accepts and keeps new features
+  for (const kodi::addon::Joystick& joystick : joysticks)
+  {
+    ASSERT_TRUE(database.MapFeatures(joystick, CONTROLLER_ID, CreateFeatures(11)));
+    ASSERT_TRUE(database.SaveButtonMap(joystick));
+    EXPECT_TRUE(HasButton(database.GetButtonMap(joystick), 11));
+  }
+}
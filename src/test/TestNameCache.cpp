@@ -0,0 +1,155 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "utils/NameCache.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using namespace JOYSTICK;
+
+namespace
+{
+  unsigned int sanitizeCount = 0;
+
+  std::string CountingSanitize(const std::string& strName)
+  {
+    sanitizeCount++;
+    return CNameCache::Sanitize(strName);
+  }
+
+  class TestNameCache : public ::testing::Test
+  {
+  protected:
+    void SetUp(void) override
+    {
+      sanitizeCount = 0;
+    }
+  };
+}
+
+TEST(TestNameSanitizing, MACAddressIsRemoved)
+{
+  EXPECT_EQ("Wireless Controller ", CNameCache::Sanitize("Wireless Controller (00:1f:E2:a3:4b:5c)"));
+  EXPECT_EQ("Wireless Controller ", CNameCache::Sanitize("Wireless Controller [00-1F-E2-A3-4B-5C]"));
+  EXPECT_EQ("Wireless Controller ", CNameCache::Sanitize("Wireless Controller 00:1F:E2:A3:4B:5C"));
+}
+
+TEST(TestNameSanitizing, NameWithoutMACAddressIsKept)
+{
+  EXPECT_EQ("Xbox 360 Controller", CNameCache::Sanitize("Xbox 360 Controller"));
+
+  // Too few octets for a MAC address
+  EXPECT_EQ("Pad 00:1F:E2:A3:4B", CNameCache::Sanitize("Pad 00:1F:E2:A3:4B"));
+}
+
+TEST(TestNameSanitizing, ControlCharactersAreReplaced)
+{
+  EXPECT_EQ("Bad Pad", CNameCache::Sanitize("Bad\nPad"));
+  EXPECT_EQ("Bad Pad", CNameCache::Sanitize("Bad\tPad"));
+}
+
+TEST_F(TestNameCache, MissSanitizes)
+{
+  CNameCache cache(CountingSanitize);
+
+  EXPECT_EQ("Wireless Controller ", cache.Get("Wireless Controller (00:1F:E2:A3:4B:5C)"));
+  EXPECT_EQ(1u, sanitizeCount);
+
+  EXPECT_EQ("Xbox 360 Controller", cache.Get("Xbox 360 Controller"));
+  EXPECT_EQ(2u, sanitizeCount);
+}
+
+TEST_F(TestNameCache, HitSkipsSanitizing)
+{
+  CNameCache cache(CountingSanitize);
+
+  for (unsigned int i = 0; i < 3; i++)
+  {
+    EXPECT_EQ("Wireless Controller ", cache.Get("Wireless Controller (00:1F:E2:A3:4B:5C)"));
+    EXPECT_EQ("Xbox 360 Controller", cache.Get("Xbox 360 Controller"));
+  }
+
+  EXPECT_EQ(2u, sanitizeCount);
+}
+
+TEST_F(TestNameCache, ClearedWhenFull)
+{
+  CNameCache cache(CountingSanitize, 2);
+
+  cache.Get("Pad 1");
+  cache.Get("Pad 2");
+  cache.Get("Pad 3"); // Clears the cache
+  EXPECT_EQ(3u, sanitizeCount);
+
+  cache.Get("Pad 3");
+  EXPECT_EQ(3u, sanitizeCount);
+
+  cache.Get("Pad 1");
+  EXPECT_EQ(4u, sanitizeCount);
+}
+
+/*!
+ * \brief Compare the cost of naming the joysticks of a scan with and without
+ *        the cache
+ *
+ * Timings are only reported, as they depend on the machine.
+ */
+TEST_F(TestNameCache, ScanBenchmark)
+{
+  const std::vector<std::string> names = {
+    "Wireless Controller (00:1F:E2:A3:4B:5C)",
+    "Sony PLAYSTATION(R)3 Controller [00:1F:E2:A3:4B:5D]",
+    "Xbox 360 Controller",
+    "8Bitdo SNES30 GamePad",
+  };
+
+  const unsigned int SCAN_COUNT = 10000;
+
+  typedef std::chrono::steady_clock Clock;
+
+  const Clock::time_point uncachedStart = Clock::now();
+  for (unsigned int scan = 0; scan < SCAN_COUNT; scan++)
+  {
+    for (const std::string& name : names)
+      EXPECT_FALSE(CNameCache::Sanitize(name).empty());
+  }
+  const Clock::duration uncached = Clock::now() - uncachedStart;
+
+  CNameCache cache(CountingSanitize);
+
+  const Clock::time_point cachedStart = Clock::now();
+  for (unsigned int scan = 0; scan < SCAN_COUNT; scan++)
+  {
+    for (const std::string& name : names)
+      EXPECT_FALSE(cache.Get(name).empty());
+  }
+  const Clock::duration cached = Clock::now() - cachedStart;
+
+  EXPECT_EQ(names.size(), sanitizeCount);
+
+  using std::chrono::nanoseconds;
+  std::cout << "Per-scan cost of " << names.size() << " names: "
+            << std::chrono::duration_cast<nanoseconds>(uncached).count() / SCAN_COUNT << " ns uncached, "
+            << std::chrono::duration_cast<nanoseconds>(cached).count() / SCAN_COUNT << " ns cached" << std::endl;
+}
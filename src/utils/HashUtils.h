@@ -0,0 +1,61 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace JOYSTICK
+{
+  /*!
+   * \brief FNV-1a hashing, folded over several fields in turn
+   */
+  class HashUtils
+  {
+  public:
+    static const uint64_t OFFSET_BASIS = 14695981039346656037ULL;
+
+    static void HashBytes(uint64_t& hash, const void* data, size_t size)
+    {
+      const unsigned char* bytes = static_cast<const unsigned char*>(data);
+      for (size_t i = 0; i < size; i++)
+      {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL; // FNV prime
+      }
+    }
+
+    template<typename T>
+    static void HashValue(uint64_t& hash, T value)
+    {
+      HashBytes(hash, &value, sizeof(value));
+    }
+
+    /*!
+     * \brief Hash a string, including the terminator so that "ab" + "c"
+     *        differs from "a" + "bc"
+     */
+    static void HashString(uint64_t& hash, const std::string& str)
+    {
+      HashBytes(hash, str.c_str(), str.size() + 1);
+    }
+  };
+}
@@ -0,0 +1,63 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "NameCache.h"
+#include "StringUtils.h"
+
+using namespace JOYSTICK;
+using namespace P8PLATFORM;
+
+CNameCache::CNameCache(SanitizeFunc sanitize /* = Sanitize */, unsigned int maxSize /* = MAX_NAME_CACHE_SIZE */) :
+  m_sanitize(sanitize),
+  m_maxSize(maxSize)
+{
+}
+
+std::string CNameCache::Get(const std::string& strName)
+{
+  {
+    CLockObject lock(m_mutex);
+
+    auto it = m_names.find(strName);
+    if (it != m_names.end())
+      return it->second;
+  }
+
+  std::string strSanitized = m_sanitize(strName);
+
+  CLockObject lock(m_mutex);
+
+  if (m_names.size() >= m_maxSize)
+    m_names.clear();
+
+  m_names[strName] = strSanitized;
+
+  return strSanitized;
+}
+
+std::string CNameCache::Sanitize(const std::string& strName)
+{
+  std::string strSanitized = StringUtils::MakeSafeString(strName);
+
+  // Remove Bluetooth MAC address as seen in Sony Playstation controllers
+  StringUtils::RemoveMACAddress(strSanitized);
+
+  return strSanitized;
+}
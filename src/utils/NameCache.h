@@ -0,0 +1,65 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "p8-platform/threads/mutex.h"
+
+#include <map>
+#include <string>
+
+#define MAX_NAME_CACHE_SIZE  64 // Cleared when full; devices rarely exceed a handful of names
+
+namespace JOYSTICK
+{
+  /*!
+   * \brief Memoizes sanitized device names
+   *
+   * The same devices are recreated on every scan (e.g. reconnecting
+   * Bluetooth pads), so their raw names are sanitized once and then looked
+   * up. The cache is cleared when it reaches its maximum size.
+   */
+  class CNameCache
+  {
+  public:
+    typedef std::string (*SanitizeFunc)(const std::string& strName);
+
+    /*!
+     * \param sanitize The function used when a name isn't cached
+     * \param maxSize The number of names kept before the cache is cleared
+     */
+    CNameCache(SanitizeFunc sanitize = Sanitize, unsigned int maxSize = MAX_NAME_CACHE_SIZE);
+
+    /*!
+     * \brief Get the sanitized form of a name
+     */
+    std::string Get(const std::string& strName);
+
+    /*!
+     * \brief Strip control characters and MAC addresses from a device name
+     */
+    static std::string Sanitize(const std::string& strName);
+
+  private:
+    const SanitizeFunc                 m_sanitize;
+    const unsigned int                 m_maxSize;
+    std::map<std::string, std::string> m_names; // Raw name -> sanitized name
+    P8PLATFORM::CMutex                 m_mutex;
+  };
+}
@@ -0,0 +1,70 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ReadWriteLock.h"
+
+using namespace JOYSTICK;
+
+void CReadWriteLock::LockShared(void)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  m_readersCondition.wait(lock, [this]() { return !m_bWriting && m_waitingWriters == 0; });
+
+  ++m_readers;
+}
+
+void CReadWriteLock::UnlockShared(void)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  if (--m_readers == 0 && m_waitingWriters > 0)
+  {
+    lock.unlock();
+    m_writersCondition.notify_one();
+  }
+}
+
+void CReadWriteLock::LockExclusive(void)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  ++m_waitingWriters;
+  m_writersCondition.wait(lock, [this]() { return !m_bWriting && m_readers == 0; });
+  --m_waitingWriters;
+
+  m_bWriting = true;
+}
+
+void CReadWriteLock::UnlockExclusive(void)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  m_bWriting = false;
+
+  const bool bWritersWaiting = (m_waitingWriters > 0);
+
+  lock.unlock();
+
+  if (bWritersWaiting)
+    m_writersCondition.notify_one();
+  else
+    m_readersCondition.notify_all();
+}
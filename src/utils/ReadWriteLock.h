@@ -0,0 +1,88 @@
+/*
+ *      Copyright (C) 2017 Garrett Brown
+ *      Copyright (C) 2017 Team Kodi
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this Program; see the file COPYING.  If not, see
+ *  <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+
+namespace JOYSTICK
+{
+  /*!
+   * \brief Lock allowing many readers or a single writer
+   *
+   * Writers are preferred: once a writer is waiting, new readers block until
+   * it has finished, so a steady stream of lookups can't starve an update.
+   * The lock is not recursive.
+   */
+  class CReadWriteLock
+  {
+  public:
+    CReadWriteLock(void) = default;
+
+    void LockShared(void);
+    void UnlockShared(void);
+
+    void LockExclusive(void);
+    void UnlockExclusive(void);
+
+  private:
+    CReadWriteLock(const CReadWriteLock&) = delete;
+    CReadWriteLock& operator=(const CReadWriteLock&) = delete;
+
+    std::mutex              m_mutex;
+    std::condition_variable m_readersCondition;
+    std::condition_variable m_writersCondition;
+    unsigned int            m_readers = 0;
+    unsigned int            m_waitingWriters = 0;
+    bool                    m_bWriting = false;
+  };
+
+  /*!
+   * \brief Scoped shared (read) lock, see CLockObject
+   */
+  class CReadLock
+  {
+  public:
+    explicit CReadLock(CReadWriteLock& lock) : m_lock(lock) { m_lock.LockShared(); }
+    ~CReadLock(void) { m_lock.UnlockShared(); }
+
+  private:
+    CReadLock(const CReadLock&) = delete;
+    CReadLock& operator=(const CReadLock&) = delete;
+
+    CReadWriteLock& m_lock;
+  };
+
+  /*!
+   * \brief Scoped exclusive (write) lock, see CLockObject
+   */
+  class CWriteLock
+  {
+  public:
+    explicit CWriteLock(CReadWriteLock& lock) : m_lock(lock) { m_lock.LockExclusive(); }
+    ~CWriteLock(void) { m_lock.UnlockExclusive(); }
+
+  private:
+    CWriteLock(const CWriteLock&) = delete;
+    CWriteLock& operator=(const CWriteLock&) = delete;
+
+    CReadWriteLock& m_lock;
+  };
+}
@@ -84,7 +84,9 @@ std::string StringUtils::MakeSafeString(std::string str)
 
 std::string& StringUtils::RemoveMACAddress(std::string& str)
 {
-  pcrecpp::RE re("[\\(\\[]?([0-9A-Fa-f]{2}[:-]){5}([0-9A-Fa-f]{2})[\\)\\]]?");
+  // Compiled once, matching is thread-safe on a const pattern
+  static const pcrecpp::RE re("[\\(\\[]?([0-9A-Fa-f]{2}[:-]){5}([0-9A-Fa-f]{2})[\\)\\]]?");
+
   re.GlobalReplace("", &str);
   return str;
 }